@@ -1,9 +1,14 @@
 from esphome.const import (
     DEVICE_CLASS_TEMPERATURE,
     DEVICE_CLASS_POWER,
+    DEVICE_CLASS_ENERGY,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
     UNIT_CELSIUS,
+    UNIT_MILLISECOND,
     UNIT_WATT,
+    UNIT_KILOWATT_HOURS,
 )
 import esphome.codegen as cg
 import esphome.config_validation as cv
@@ -21,6 +26,9 @@ PanasonicACCNT = panasonic_ac_cnt_ns.class_("PanasonicACCNT", PanasonicAC)
 panasonic_ac_wlan_ns = panasonic_ac_ns.namespace("WLAN")
 PanasonicACWLAN = panasonic_ac_wlan_ns.class_("PanasonicACWLAN", PanasonicAC)
 
+LinkCounter = panasonic_ac_ns.enum("LinkCounter")
+RawType = panasonic_ac_ns.enum("RawType", is_class=True)
+
 PanasonicACSwitch = panasonic_ac_ns.class_(
     "PanasonicACSwitch", switch.Switch, cg.Component
 )
@@ -40,9 +48,50 @@ CONF_ECO_SWITCH = "eco_switch"
 CONF_ECONAVI_SWITCH = "econavi_switch"
 CONF_MILD_DRY_SWITCH = "mild_dry_switch"
 CONF_CURRENT_POWER_CONSUMPTION = "current_power_consumption"
+CONF_ENERGY_TOTAL = "energy_total"
+CONF_ENERGY_HOUR = "energy_hour"
+CONF_ENERGY_DAY = "energy_day"
+CONF_COMMAND_LATENCY_P50 = "command_latency_p50"
+CONF_COMMAND_LATENCY_P95 = "command_latency_p95"
+CONF_COMMAND_LATENCY_MAX = "command_latency_max"
+CONF_POLL_INTERVAL_MIN = "poll_interval_min"
+CONF_POLL_INTERVAL_MAX = "poll_interval_max"
+CONF_TRACE_FREEZE_ON_ERROR = "trace_freeze_on_error"
+CONF_RAW_SENSORS = "raw_sensors"
+CONF_KEY = "key"
+CONF_TYPE = "type"
+CONF_SCALE = "scale"
+CONF_OFFSET = "offset"
 CONF_WLAN = "wlan"
 CONF_CNT = "cnt"
 
+# Link counters that can be published as sensors, with the unit of their per minute rate
+LINK_COUNTERS = {
+    "frames_in": "frames/min",
+    "bytes_in": "B/min",
+    "frames_out": "frames/min",
+    "bytes_out": "B/min",
+    "drops_length": "frames/min",
+    "drops_header": "frames/min",
+    "drops_length_mismatch": "frames/min",
+    "drops_checksum": "frames/min",
+    "resends": "frames/min",
+    "counter_corrections": "1/min",
+    "overflows": "B/min",
+    "resyncs": "1/min",
+    "tx_drops": "frames/min",
+}
+
+# How raw sensors read the value of a key
+RAW_TYPES = {
+    "u8": RawType.U8,
+    "i8": RawType.I8,
+    "u16be": RawType.U16BE,
+    "u16le": RawType.U16LE,
+}
+
+RAW_SENSORS_MAX = 16  # As in esppac_wlan.h
+
 HORIZONTAL_SWING_OPTIONS = ["Swing", "Left", "Center Left", "Center", "Center Right", "Right"]
 
 VERTICAL_SWING_OPTIONS = ["Swing", "Auto", "Top", "Middle Top", "Middle", "Middle Bottom", "Bottom"]
@@ -51,6 +100,14 @@ SWITCH_SCHEMA = switch.switch_schema(PanasonicACSwitch).extend(cv.COMPONENT_SCHE
 
 SELECT_SCHEMA = select.select_schema(PanasonicACSelect)
 
+LATENCY_SENSOR_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MILLISECOND,
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    icon="mdi:timer-outline",
+)
+
 PANASONIC_COMMON_SCHEMA = {
     cv.Optional(CONF_VERTICAL_SWING_ENABLE, default=True): cv.boolean,
     cv.Optional(CONF_HORIZONTAL_SWING_SELECT): SELECT_SCHEMA,
@@ -69,8 +126,45 @@ PANASONIC_COMMON_SCHEMA = {
 	state_class=STATE_CLASS_MEASUREMENT,
     ),
     cv.Optional(CONF_NANOEX_SWITCH): SWITCH_SCHEMA,
+    cv.Optional(CONF_COMMAND_LATENCY_P50): LATENCY_SENSOR_SCHEMA,
+    cv.Optional(CONF_COMMAND_LATENCY_P95): LATENCY_SENSOR_SCHEMA,
+    cv.Optional(CONF_COMMAND_LATENCY_MAX): LATENCY_SENSOR_SCHEMA,
+    **{
+        cv.Optional(f"link_{counter}"): sensor.sensor_schema(
+            unit_of_measurement=unit,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon="mdi:swap-horizontal",
+        )
+        for counter, unit in LINK_COUNTERS.items()
+    },
+    cv.Optional(CONF_TRACE_FREEZE_ON_ERROR, default=False): cv.boolean,
 }
 
+RAW_SENSOR_SCHEMA = sensor.sensor_schema(
+    accuracy_decimals=1,
+    state_class=STATE_CLASS_MEASUREMENT,
+).extend(
+    {
+        cv.Required(CONF_KEY): cv.hex_uint8_t,
+        cv.Optional(CONF_TYPE, default="u8"): cv.enum(RAW_TYPES, lower=True),
+        cv.Optional(CONF_SCALE, default=1.0): cv.float_,
+        cv.Optional(CONF_OFFSET, default=0): cv.int_range(min=0, max=255),
+    }
+)
+
+PANASONIC_WLAN_SCHEMA = {
+    cv.Optional(CONF_RAW_SENSORS): cv.All(cv.ensure_list(RAW_SENSOR_SCHEMA), cv.Length(max=RAW_SENSORS_MAX)),
+}
+
+ENERGY_SENSOR_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_KILOWATT_HOURS,
+    accuracy_decimals=3,
+    device_class=DEVICE_CLASS_ENERGY,
+    state_class=STATE_CLASS_TOTAL_INCREASING,
+)
+
 PANASONIC_CNT_SCHEMA = {
     cv.Optional(CONF_ECO_SWITCH): SWITCH_SCHEMA,
     cv.Optional(CONF_ECONAVI_SWITCH): SWITCH_SCHEMA,
@@ -82,12 +176,25 @@ PANASONIC_CNT_SCHEMA = {
         device_class=DEVICE_CLASS_POWER,
         state_class=STATE_CLASS_MEASUREMENT,
     ),
+    cv.Optional(CONF_ENERGY_TOTAL): ENERGY_SENSOR_SCHEMA,
+    cv.Optional(CONF_ENERGY_HOUR): ENERGY_SENSOR_SCHEMA,
+    cv.Optional(CONF_ENERGY_DAY): ENERGY_SENSOR_SCHEMA,
+    cv.Optional(CONF_POLL_INTERVAL_MIN, default="2s"): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_POLL_INTERVAL_MAX, default="60s"): cv.positive_time_period_milliseconds,
 }
 
+def validate_poll_interval(config):
+    if config[CONF_POLL_INTERVAL_MIN] > config[CONF_POLL_INTERVAL_MAX]:
+        raise cv.Invalid(f"{CONF_POLL_INTERVAL_MIN} must not be larger than {CONF_POLL_INTERVAL_MAX}")
+    return config
+
 CONFIG_SCHEMA = cv.typed_schema(
     {
-        CONF_WLAN: climate.climate_schema(PanasonicACWLAN).extend(PANASONIC_COMMON_SCHEMA).extend(uart.UART_DEVICE_SCHEMA),
-        CONF_CNT: climate.climate_schema(PanasonicACCNT).extend(PANASONIC_COMMON_SCHEMA).extend(PANASONIC_CNT_SCHEMA).extend(uart.UART_DEVICE_SCHEMA),
+        CONF_WLAN: climate.climate_schema(PanasonicACWLAN).extend(PANASONIC_COMMON_SCHEMA).extend(PANASONIC_WLAN_SCHEMA).extend(uart.UART_DEVICE_SCHEMA),
+        CONF_CNT: cv.All(
+            climate.climate_schema(PanasonicACCNT).extend(PANASONIC_COMMON_SCHEMA).extend(PANASONIC_CNT_SCHEMA).extend(uart.UART_DEVICE_SCHEMA),
+            validate_poll_interval,
+        ),
     }
 )
 
@@ -136,3 +243,31 @@ async def to_code(config):
     if CONF_CURRENT_POWER_CONSUMPTION in config:
         sens = await sensor.new_sensor(config[CONF_CURRENT_POWER_CONSUMPTION])
         cg.add(var.set_current_power_consumption_sensor(sens))
+
+    for s in [CONF_ENERGY_TOTAL, CONF_ENERGY_HOUR, CONF_ENERGY_DAY]:
+        if s in config:
+            sens = await sensor.new_sensor(config[s])
+            cg.add(getattr(var, f"set_{s}_sensor")(sens))
+
+    for s in [CONF_COMMAND_LATENCY_P50, CONF_COMMAND_LATENCY_P95, CONF_COMMAND_LATENCY_MAX]:
+        if s in config:
+            sens = await sensor.new_sensor(config[s])
+            cg.add(getattr(var, f"set_{s}_sensor")(sens))
+
+    for counter in LINK_COUNTERS:
+        if f"link_{counter}" in config:
+            sens = await sensor.new_sensor(config[f"link_{counter}"])
+            cg.add(var.set_link_sensor(getattr(LinkCounter, f"LINK_{counter.upper()}"), sens))
+
+    for conf in config.get(CONF_RAW_SENSORS, []):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.add_raw_sensor(conf[CONF_KEY], conf[CONF_TYPE], conf[CONF_SCALE], conf[CONF_OFFSET], sens))
+
+    if CONF_TRACE_FREEZE_ON_ERROR in config:
+        cg.add(var.set_trace_freeze_on_error(config[CONF_TRACE_FREEZE_ON_ERROR]))
+
+    if CONF_POLL_INTERVAL_MIN in config:
+        cg.add(var.set_poll_interval(
+            config[CONF_POLL_INTERVAL_MIN].total_milliseconds,
+            config[CONF_POLL_INTERVAL_MAX].total_milliseconds,
+        ))
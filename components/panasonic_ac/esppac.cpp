@@ -1,5 +1,8 @@
 #include "esppac.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "esphome/core/log.h"
 
 namespace esphome {
@@ -49,33 +52,249 @@ void PanasonicAC::setup() {
 
 void PanasonicAC::loop() {
   read_data();  // Read data from UART (if there is any)
+  publish_pending();
 }
 
 void PanasonicAC::read_data() {
-  while (available())  // Read while data is available
+  int available;
+
+  while ((available = this->available()) > 0)  // Read while data is available
   {
-    // if (this->receive_buffer_index >= BUFFER_SIZE) {
-    //   ESP_LOGE(TAG, "Receive buffer overflow");
-    //   receiveBufferIndex = 0;
-    // }
+    size_t length = std::min<size_t>(available, RX_CHUNK_SIZE);
+    uint8_t *chunk = this->rx_ring_.write_span(&length);
 
-    uint8_t c;
-    this->read_byte(&c);  // Store in receive buffer
-    this->rx_buffer_.push_back(c);
+    if (length == 0) {
+      // Ring is full, keep draining the UART but count what we had to throw away
+      uint8_t discard[RX_CHUNK_SIZE];
+      length = std::min<size_t>(available, sizeof(discard));
+
+      if (!this->read_array(discard, length))
+        break;
+
+      if (this->link_.total(LINK_OVERFLOWS) == 0)
+        ESP_LOGW(TAG, "Receive buffer overflow");
+      this->link_error(LINK_OVERFLOWS, length);
+    } else {
+      if (!this->read_array(chunk, length))  // Store in receive ring
+        break;
+
+      this->rx_ring_.commit(length);
+    }
 
+    this->link_.count(LINK_BYTES_IN, length);
     this->last_read_ = millis();  // Update lastRead timestamp
   }
 }
 
+/*
+ * Packet framing
+ */
+
+bool PanasonicAC::read_packet() {
+  if (this->rx_packet_ready_)  // Previous packet has been handled, start a new one
+    reset_packet();
+
+  uint8_t c;
+
+  while (next_byte(&c)) {
+    if (this->rx_buffer_.empty() && !is_packet_header(c))
+      continue;  // Skip everything until we find a header
+
+    this->rx_buffer_.push_back(c);
+    this->rx_checksum_ += c;
+
+    if (this->rx_expected_length_ == 0) {
+      this->rx_expected_length_ = packet_length();
+
+      if (this->rx_expected_length_ > BUFFER_SIZE) {
+        log_packet(this->rx_buffer_);
+        ESP_LOGD(TAG, "Dropping invalid packet (length field), resynchronizing");
+        this->link_.count(LINK_FRAMES_IN);
+        this->link_error(LINK_DROPS_LENGTH_MISMATCH);
+        resync_packet();
+        continue;
+      }
+    }
+
+    if (this->rx_expected_length_ != 0 && this->rx_buffer_.size() == this->rx_expected_length_) {
+      if (this->rx_checksum_ != 0) {
+        log_packet(this->rx_buffer_);
+        ESP_LOGD(TAG, "Dropping invalid packet (checksum), resynchronizing");
+        this->link_.count(LINK_FRAMES_IN);
+        this->link_error(LINK_DROPS_CHECKSUM);
+        resync_packet();
+        continue;
+      }
+
+      this->rx_packet_ready_ = true;  // Last byte arrived, hand the packet out immediately
+      this->link_.count(LINK_FRAMES_IN);
+      return true;
+    } else if (this->rx_buffer_.full()) {
+      log_packet(this->rx_buffer_);
+      ESP_LOGW(TAG, "Packet too long, resynchronizing");
+      this->link_error(LINK_OVERFLOWS);
+      resync_packet();
+    }
+  }
+
+  // Fall back to the idle gap for packets whose length cannot be determined
+  if (!this->rx_buffer_.empty() && millis() - this->last_read_ > READ_TIMEOUT) {
+    this->rx_packet_ready_ = true;
+    this->link_.count(LINK_FRAMES_IN);
+    return true;
+  }
+
+  return false;
+}
+
+bool PanasonicAC::next_byte(uint8_t *byte) {
+  if (this->rx_resync_index_ < this->rx_resync_.size()) {
+    *byte = this->rx_resync_[this->rx_resync_index_++];
+    return true;
+  }
+
+  return this->rx_ring_.pop(byte);
+}
+
+void PanasonicAC::resync_packet() {
+  this->link_.count(LINK_RESYNCS);
+
+  // Everything after the rejected header might contain the start of a valid packet, so parse it again
+  uint8_t pending[RX_RING_SIZE];
+  size_t length = 0;
+
+  for (size_t i = 1; i < this->rx_buffer_.size(); i++)
+    pending[length++] = this->rx_buffer_[i];
+
+  for (size_t i = this->rx_resync_index_; i < this->rx_resync_.size(); i++)
+    pending[length++] = this->rx_resync_[i];
+
+  reset_packet();
+
+  this->rx_resync_.clear();
+  this->rx_resync_index_ = 0;
+
+  for (size_t i = 0; i < length; i++)
+    this->rx_resync_.push_back(pending[i]);
+}
+
+void PanasonicAC::reset_packet() {
+  this->rx_buffer_.clear();
+  this->rx_expected_length_ = 0;
+  this->rx_checksum_ = 0;
+  this->rx_packet_ready_ = false;
+}
+
+/*
+ * Transmitting
+ */
+
+bool PanasonicAC::queue_frame(const uint8_t *data, size_t length, CommandType type, TxPriority priority) {
+  if (this->tx_queue_.push(data, length, static_cast<uint8_t>(priority), static_cast<uint8_t>(type))) {
+    this->handle_tx();  // Written right away if the line is free, the queue only holds frames while it is busy
+    return true;
+  }
+
+  if (this->link_.total(LINK_TX_DROPS) == 0)
+    ESP_LOGW(TAG, "Transmit queue full, dropping frame");
+  this->link_error(LINK_TX_DROPS);
+  return false;
+}
+
+void PanasonicAC::handle_tx() {
+  if (this->tx_queue_.empty())
+    return;
+
+  // Frames are only written into an empty TX FIFO so write_array never blocks. The UART API doesn't tell how much of
+  // the FIFO is free, so the time the last frame needs to leave it is estimated from its length instead
+  if (micros() - this->tx_written_at_ < this->tx_busy_time_)
+    return;
+
+  auto *entry = this->tx_queue_.front();
+  auto &packet = entry->packet;
+
+  this->prepare_frame(packet.data(), packet.size(), static_cast<CommandType>(entry->tag));
+  this->write_array(packet.data(), packet.size());
+  this->log_packet(packet, true);
+  this->link_.count(LINK_FRAMES_OUT);
+  this->link_.count(LINK_BYTES_OUT, packet.size());
+
+  this->tx_written_at_ = micros();
+  this->tx_busy_time_ = packet.size() * TX_BYTE_TIME + this->tx_frame_gap_;
+  this->last_packet_sent_ = millis();
+
+  this->tx_queue_.pop();
+}
+
+/*
+ * Command latency, from the request of a command to the AC reporting every value it requested
+ */
+
+// Edits merged into a command that is still waiting keep its start
+void PanasonicAC::command_queued() {
+  if (this->command_stage_ == CommandStage::Queued)
+    return;
+
+  this->command_stage_ = CommandStage::Queued;
+  this->command_queued_at_ = millis();
+  this->command_timed_out_ = false;
+}
+
+// Resends don't restart the timeline, it counts from the first time the command was written
+void PanasonicAC::command_transmitted() {
+  if (this->command_stage_ != CommandStage::Queued)
+    return;
+
+  this->command_transmitted_at_ = millis();
+  this->transmit_latency_.add(this->command_transmitted_at_ - this->command_queued_at_);
+  this->command_stage_ = CommandStage::Transmitted;
+}
+
+void PanasonicAC::command_acknowledged() {
+  if (this->command_stage_ != CommandStage::Transmitted)
+    return;
+
+  this->ack_latency_.add(millis() - this->command_transmitted_at_);
+  this->command_stage_ = CommandStage::Acknowledged;
+}
+
+// Called once no value of the command is pending anymore, because the AC reported it or the request timed out
+void PanasonicAC::command_settled() {
+  if (this->command_stage_ == CommandStage::Idle || this->command_stage_ == CommandStage::Queued)
+    return;
+
+  if (this->command_timed_out_) {
+    this->commands_unconfirmed_++;
+  } else {
+    this->confirm_latency_.add(millis() - this->command_queued_at_);
+    this->dirty_ |= DIRTY_COMMAND_LATENCY;
+  }
+
+  this->command_stage_ = CommandStage::Idle;
+}
+
+// The command was not written, e.g. because the AC is already in the requested state
+void PanasonicAC::command_dropped() {
+  if (this->command_stage_ == CommandStage::Queued)
+    this->command_stage_ = CommandStage::Idle;
+}
+
 void PanasonicAC::update_outside_temperature(int8_t temperature) {
   if (temperature > TEMPERATURE_THRESHOLD) {
     ESP_LOGW(TAG, "Received out of range outside temperature: %d", temperature);
     return;
   }
 
-  if (this->outside_temperature_sensor_ != nullptr && this->outside_temperature_sensor_->state != temperature)
-    this->outside_temperature_sensor_->publish_state(
-        temperature);  // Set current (outside) temperature; no temperature steps
+  if (this->outside_temperature_sensor_ == nullptr)
+    return;
+
+  if (this->outside_temperature_state_ == temperature) {
+    this->publishes_suppressed_++;
+    return;
+  }
+
+  this->outside_temperature_state_ = temperature;  // Set current (outside) temperature; no temperature steps
+  this->dirty_ |= DIRTY_OUTSIDE_TEMPERATURE;
 }
 
 void PanasonicAC::update_inside_temperature(int8_t temperature) {
@@ -84,9 +303,16 @@ void PanasonicAC::update_inside_temperature(int8_t temperature) {
     return;
   }
 
-  if (this->inside_temperature_sensor_ != nullptr && this->inside_temperature_sensor_->state != temperature)
-    this->inside_temperature_sensor_->publish_state(
-        temperature);  // Set current (inside) temperature; no temperature steps
+  if (this->inside_temperature_sensor_ == nullptr)
+    return;
+
+  if (this->inside_temperature_state_ == temperature) {
+    this->publishes_suppressed_++;
+    return;
+  }
+
+  this->inside_temperature_state_ = temperature;  // Set current (inside) temperature; no temperature steps
+  this->dirty_ |= DIRTY_INSIDE_TEMPERATURE;
 }
 
 void PanasonicAC::update_current_temperature(int8_t temperature) {
@@ -109,49 +335,81 @@ void PanasonicAC::update_target_temperature(uint8_t raw_value) {
   this->target_temperature = temperature;
 }
 
-void PanasonicAC::update_swing_horizontal(const std::string &Swing) {
-  this->horizontal_swing_state_ = Swing;
+/*
+ * Select and switch states are compared against what the entity shows, so an optimistic state set by a change
+ * request is published again if the AC reports back something else
+ */
+
+void PanasonicAC::update_swing_horizontal(const char *swing) {
+  this->horizontal_swing_state_ = swing;
 
-  if (this->horizontal_swing_select_ != nullptr &&
-      this->horizontal_swing_select_->state != this->horizontal_swing_state_) {
-    this->horizontal_swing_select_->publish_state(
-        this->horizontal_swing_state_);  // Set current horizontal swing position
-  }
+  if (this->horizontal_swing_select_ == nullptr)
+    return;
+
+  if (this->horizontal_swing_select_->state == swing)
+    this->publishes_suppressed_++;
+  else
+    this->dirty_ |= DIRTY_HORIZONTAL_SWING;
 }
 
-void PanasonicAC::update_swing_vertical(const std::string &Swing) {
-  this->vertical_swing_state_ = Swing;
+void PanasonicAC::update_swing_vertical(const char *swing) {
+  this->vertical_swing_state_ = swing;
 
-  if (this->vertical_swing_select_ != nullptr && this->vertical_swing_select_->state != this->vertical_swing_state_)
-    this->vertical_swing_select_->publish_state(this->vertical_swing_state_);  // Set current vertical swing position
+  if (this->vertical_swing_select_ == nullptr)
+    return;
+
+  if (this->vertical_swing_select_->state == swing)
+    this->publishes_suppressed_++;
+  else
+    this->dirty_ |= DIRTY_VERTICAL_SWING;
 }
 
 void PanasonicAC::update_nanoex(bool nanoex) {
-  if (this->nanoex_switch_ != nullptr) {
-    this->nanoex_state_ = nanoex;
-    this->nanoex_switch_->publish_state(this->nanoex_state_);
-  }
+  if (this->nanoex_switch_ == nullptr)
+    return;
+
+  this->nanoex_state_ = nanoex;
+
+  if (this->nanoex_switch_->state == nanoex)
+    this->publishes_suppressed_++;
+  else
+    this->dirty_ |= DIRTY_NANOEX;
 }
 
 void PanasonicAC::update_eco(bool eco) {
-  if (this->eco_switch_ != nullptr) {
-    this->eco_state_ = eco;
-    this->eco_switch_->publish_state(this->eco_state_);
-  }
+  if (this->eco_switch_ == nullptr)
+    return;
+
+  this->eco_state_ = eco;
+
+  if (this->eco_switch_->state == eco)
+    this->publishes_suppressed_++;
+  else
+    this->dirty_ |= DIRTY_ECO;
 }
 
 void PanasonicAC::update_econavi(bool econavi) {
-  if (this->econavi_switch_ != nullptr) {
-    this->econavi_state_ = econavi;
-    this->econavi_switch_->publish_state(this->econavi_state_);
-  }
+  if (this->econavi_switch_ == nullptr)
+    return;
+
+  this->econavi_state_ = econavi;
+
+  if (this->econavi_switch_->state == econavi)
+    this->publishes_suppressed_++;
+  else
+    this->dirty_ |= DIRTY_ECONAVI;
 }
 
 void PanasonicAC::update_mild_dry(bool mild_dry) {
-  if (this->mild_dry_switch_ != nullptr) {
-    this->mild_dry_state_ = mild_dry;
-    this->mild_dry_switch_->publish_state(this->mild_dry_state_);
-  }
+  if (this->mild_dry_switch_ == nullptr)
+    return;
+
+  this->mild_dry_state_ = mild_dry;
+
+  if (this->mild_dry_switch_->state == mild_dry)
+    this->publishes_suppressed_++;
+  else
+    this->dirty_ |= DIRTY_MILD_DRY;
 }
 
 climate::ClimateAction PanasonicAC::determine_action() {
@@ -173,12 +431,150 @@ climate::ClimateAction PanasonicAC::determine_action() {
 }
 
 void PanasonicAC::update_current_power_consumption(int16_t power) {
-  if (this->current_power_consumption_sensor_ != nullptr && this->current_power_consumption_sensor_->state != power) {
-    this->current_power_consumption_sensor_->publish_state(
-        power);  // Set current power consumption
+  if (this->current_power_consumption_sensor_ == nullptr)
+    return;
+
+  if (this->power_consumption_state_ == power) {
+    this->publishes_suppressed_++;
+    return;
+  }
+
+  this->power_consumption_state_ = power;  // Set current power consumption
+  this->dirty_ |= DIRTY_POWER_CONSUMPTION;
+}
+
+/*
+ * Publishing
+ */
+
+// Marks the climate entity for publishing at the end of the loop, requests in between are merged
+void PanasonicAC::schedule_publish() {
+  if (this->dirty_ & DIRTY_CLIMATE)
+    this->publishes_suppressed_++;
+
+  this->dirty_ |= DIRTY_CLIMATE;
+}
+
+// Publishes every entity that changed since the last call, called once at the end of each loop
+void PanasonicAC::publish_pending() {
+  if (this->link_.update(millis()))
+    this->dirty_ |= DIRTY_LINK;  // A minute of link statistics is complete
+
+  if (this->dirty_ == 0)
+    return;
+
+  uint16_t dirty = this->dirty_;
+  this->dirty_ = 0;  // Publishing may call back into the component, which can mark entities again
+
+  if (dirty & DIRTY_OUTSIDE_TEMPERATURE) {
+    this->outside_temperature_sensor_->publish_state(this->outside_temperature_state_);
+    this->publishes_++;
+  }
+
+  if (dirty & DIRTY_INSIDE_TEMPERATURE) {
+    this->inside_temperature_sensor_->publish_state(this->inside_temperature_state_);
+    this->publishes_++;
+  }
+
+  if (dirty & DIRTY_POWER_CONSUMPTION) {
+    this->current_power_consumption_sensor_->publish_state(this->power_consumption_state_);
+    this->publishes_++;
+  }
+
+  if (dirty & DIRTY_COMMAND_LATENCY) {
+    if (this->command_latency_p50_sensor_ != nullptr) {
+      this->command_latency_p50_sensor_->publish_state(this->confirm_latency_.percentile(50));
+      this->publishes_++;
+    }
+
+    if (this->command_latency_p95_sensor_ != nullptr) {
+      this->command_latency_p95_sensor_->publish_state(this->confirm_latency_.percentile(95));
+      this->publishes_++;
+    }
+
+    if (this->command_latency_max_sensor_ != nullptr) {
+      this->command_latency_max_sensor_->publish_state(this->confirm_latency_.max());
+      this->publishes_++;
+    }
+  }
+
+  if (dirty & DIRTY_LINK) {
+    for (size_t i = 0; i < LINK_COUNTER_COUNT; i++) {
+      if (this->link_sensors_[i] == nullptr)
+        continue;
+
+      this->link_sensors_[i]->publish_state(this->link_.last_period(static_cast<LinkCounter>(i)));
+      this->publishes_++;
+    }
+  }
+
+  // The select and switch states are checked again, a change request may have caught up with them since
+  if ((dirty & DIRTY_VERTICAL_SWING) && this->vertical_swing_select_->state != this->vertical_swing_state_) {
+    this->vertical_swing_select_->publish_state(this->vertical_swing_state_);  // Set current vertical swing position
+    this->publishes_++;
+  }
+
+  if ((dirty & DIRTY_HORIZONTAL_SWING) && this->horizontal_swing_select_->state != this->horizontal_swing_state_) {
+    this->horizontal_swing_select_->publish_state(this->horizontal_swing_state_);  // Set current horizontal position
+    this->publishes_++;
+  }
+
+  if ((dirty & DIRTY_NANOEX) && this->nanoex_switch_->state != this->nanoex_state_) {
+    this->nanoex_switch_->publish_state(this->nanoex_state_);
+    this->publishes_++;
+  }
+
+  if ((dirty & DIRTY_ECO) && this->eco_switch_->state != this->eco_state_) {
+    this->eco_switch_->publish_state(this->eco_state_);
+    this->publishes_++;
+  }
+
+  if ((dirty & DIRTY_ECONAVI) && this->econavi_switch_->state != this->econavi_state_) {
+    this->econavi_switch_->publish_state(this->econavi_state_);
+    this->publishes_++;
+  }
+
+  if ((dirty & DIRTY_MILD_DRY) && this->mild_dry_switch_->state != this->mild_dry_state_) {
+    this->mild_dry_switch_->publish_state(this->mild_dry_state_);
+    this->publishes_++;
+  }
+
+  if (dirty & DIRTY_CLIMATE) {
+    if (!this->climate_changed()) {
+      this->publishes_suppressed_++;
+      return;
+    }
+
+    PublishedClimate &published = this->published_climate_;
+    published.mode = this->mode;
+    published.action = this->action;
+    published.current_temperature = this->current_temperature;
+    published.target_temperature = this->target_temperature;
+    published.fan_mode = this->fan_mode;
+    published.swing_mode = this->swing_mode;
+    published.preset = this->preset;
+    if (published.custom_preset != this->custom_preset)  // Only copy the string when it changed
+      published.custom_preset = this->custom_preset;
+    published.valid = true;
+
+    this->publish_state();
+    this->publishes_++;
   }
 }
 
+bool PanasonicAC::climate_changed() const {
+  const PublishedClimate &published = this->published_climate_;
+
+  // NAN (not known yet) compares unequal to itself
+  auto same = [](float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+
+  return !published.valid || published.mode != this->mode || published.action != this->action ||
+         !same(published.current_temperature, this->current_temperature) ||
+         !same(published.target_temperature, this->target_temperature) || published.fan_mode != this->fan_mode ||
+         published.swing_mode != this->swing_mode || published.preset != this->preset ||
+         published.custom_preset != this->custom_preset;
+}
+
 /*
  * Sensor handling
  */
@@ -197,7 +593,7 @@ void PanasonicAC::set_current_temperature_sensor(sensor::Sensor *current_tempera
   this->current_temperature_sensor_->add_on_state_callback([this](float state)
                                                            {
                                                              this->current_temperature = state;
-                                                             this->publish_state();
+                                                             this->schedule_publish();
                                                            });
 }
 
@@ -263,13 +659,86 @@ void PanasonicAC::set_current_power_consumption_sensor(sensor::Sensor *current_p
  * Debugging
  */
 
-void PanasonicAC::log_packet(std::vector<uint8_t> data, bool outgoing) {
+void PanasonicAC::dump_config() {
+  ESP_LOGCONFIG(TAG, "Panasonic AC v%s", VERSION);
+  this->dump_latency();
+  this->dump_link_stats();
+}
+
+void PanasonicAC::dump_link_stats() {
+  ESP_LOGCONFIG(TAG, "Link (total, last minute):");
+
+  for (size_t i = 0; i < LINK_COUNTER_COUNT; i++) {
+    LinkCounter counter = static_cast<LinkCounter>(i);
+    ESP_LOGCONFIG(TAG, "  %-25s %u, %u", LINK_COUNTER_NAMES[i], (unsigned) this->link_.total(counter),
+                  (unsigned) this->link_.last_period(counter));
+  }
+}
+
+void PanasonicAC::dump_latency() {
+  auto dump = [](const char *name, const LatencyHistogram &latency) {
+    ESP_LOGCONFIG(TAG, "  %-22s n=%u p50<=%u p95<=%u max=%u ms", name, (unsigned) latency.count(),
+                  (unsigned) latency.percentile(50), (unsigned) latency.percentile(95), (unsigned) latency.max());
+  };
+
+  ESP_LOGCONFIG(TAG, "Command latency:");
+  dump("requested -> written", this->transmit_latency_);
+  dump("written -> answered", this->ack_latency_);
+  dump("requested -> confirmed", this->confirm_latency_);
+  ESP_LOGCONFIG(TAG, "  %-22s %u", "never confirmed", (unsigned) this->commands_unconfirmed_);
+}
+
+// Every frame goes into the trace, formatting it for the log is left to the very verbose level
+void PanasonicAC::log_packet(const uint8_t *data, size_t length, bool outgoing) {
+  this->trace_.append(micros(), outgoing ? TRACE_OUTGOING : 0, data, length);
+
   if (outgoing) {
-    ESP_LOGV(TAG, "TX: %s", format_hex_pretty(data).c_str());
+    ESP_LOGVV(TAG, "TX: %s", format_hex_pretty(data, length).c_str());
   } else {
-    ESP_LOGV(TAG, "RX: %s", format_hex_pretty(data).c_str());
+    ESP_LOGVV(TAG, "RX: %s", format_hex_pretty(data, length).c_str());
+  }
+}
+
+// Counts a link error and freezes the trace on the first one, if configured to
+void PanasonicAC::link_error(LinkCounter counter, uint32_t n) {
+  this->link_.count(counter, n);
+
+  if (this->trace_freeze_on_error_ && !this->trace_.frozen()) {
+    this->trace_.freeze();
+    ESP_LOGW(TAG, "Packet trace frozen after %s, dump it with dump_trace()", LINK_COUNTER_NAMES[counter]);
   }
 }
 
+/*
+ * Logs the trace as hex, host/trace/trace_decode turns these lines back into frames
+ */
+void PanasonicAC::dump_trace() {
+  static const char *const HEX = "0123456789abcdef";
+  char line[2 * TRACE_DUMP_CHUNK + 1];
+
+  ESP_LOGI(TAG, "trace begin records=%u bytes=%u now=%u frozen=%d", (unsigned) this->trace_.records(),
+           (unsigned) this->trace_.size(), (unsigned) micros(), this->trace_.frozen());
+
+  for (size_t offset = 0; offset < this->trace_.size(); offset += TRACE_DUMP_CHUNK) {
+    size_t length = std::min(TRACE_DUMP_CHUNK, this->trace_.size() - offset);
+
+    for (size_t i = 0; i < length; i++) {
+      uint8_t byte = this->trace_.peek(offset + i);
+      line[2 * i] = HEX[byte >> 4];
+      line[2 * i + 1] = HEX[byte & 0x0F];
+    }
+    line[2 * length] = '\0';
+
+    ESP_LOGI(TAG, "trace %s", line);
+  }
+
+  ESP_LOGI(TAG, "trace end");
+}
+
+void PanasonicAC::resume_trace() {
+  this->trace_.resume();
+  ESP_LOGI(TAG, "Packet trace resumed");
+}
+
 }  // namespace panasonic_ac
 }  // namespace esphome
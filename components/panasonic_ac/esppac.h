@@ -6,6 +6,11 @@
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/uart/uart.h"
 #include "esphome/core/component.h"
+#include "esppac_buffer.h"
+#include "esppac_fields.h"
+#include "esppac_latency.h"
+#include "esppac_link.h"
+#include "esppac_trace.h"
 
 namespace esphome {
 
@@ -13,8 +18,15 @@ namespace panasonic_ac {
 
 static const char *const VERSION = "2.4.0";
 
-static const uint8_t BUFFER_SIZE = 128;  // The maximum size of a single packet (both receive and transmit)
-static const uint8_t READ_TIMEOUT = 20;  // The maximum time to wait before considering a packet complete
+static const size_t BUFFER_SIZE = 256;  // The maximum size of a single packet (both receive and transmit)
+static const uint8_t READ_TIMEOUT = 20;  // Idle time after which a packet of unknown length is considered complete
+static const size_t RX_RING_SIZE = 2 * BUFFER_SIZE;  // Capacity of the UART receive ring (two maximum-size packets)
+static const size_t RX_CHUNK_SIZE = 32;              // The maximum number of bytes to read from the UART at once
+static const size_t TX_FIFO_SIZE = 128;   // Size of the UART TX FIFO, frames are only written into an empty one
+static const size_t TX_QUEUE_SIZE = 4;    // The number of frames that can wait for the line to be free
+static const uint32_t TX_BYTE_TIME = 1146;  // Time (us) a byte takes on the line at 9600 baud 8E1
+static const size_t TRACE_SIZE = 2048;      // Size of the packet trace, frames take their length plus 7 bytes
+static const size_t TRACE_DUMP_CHUNK = 64;  // Trace bytes per log line when dumping it
 
 static const uint8_t MIN_TEMPERATURE = 16;     // Minimum temperature as reported by Panasonic app
 static const uint8_t MAX_TEMPERATURE = 30;     // Maximum temperature as supported by Panasonic app
@@ -25,6 +37,55 @@ static const uint8_t TEMPERATURE_THRESHOLD =
 
 enum class CommandType { Normal, Response, Resend };
 
+enum class TxPriority : uint8_t {
+  Response,  // Answers to the AC, they are expected right away
+  Command,   // Control and handshake frames
+  Poll,      // State queries, they can wait
+};
+
+/*
+ * Where the last command is on its way from control() to the AC reporting the requested state
+ */
+enum class CommandStage : uint8_t {
+  Idle,          // No command in flight
+  Queued,        // Requested, not written yet
+  Transmitted,   // Written, the AC has not answered yet
+  Acknowledged,  // Answered, the AC has not reported every requested value yet
+};
+
+/*
+ * Entities with changes that are waiting to be published by publish_pending()
+ */
+enum DirtyFlag : uint16_t {
+  DIRTY_CLIMATE = 1 << 0,
+  DIRTY_OUTSIDE_TEMPERATURE = 1 << 1,
+  DIRTY_INSIDE_TEMPERATURE = 1 << 2,
+  DIRTY_POWER_CONSUMPTION = 1 << 3,
+  DIRTY_VERTICAL_SWING = 1 << 4,
+  DIRTY_HORIZONTAL_SWING = 1 << 5,
+  DIRTY_NANOEX = 1 << 6,
+  DIRTY_ECO = 1 << 7,
+  DIRTY_ECONAVI = 1 << 8,
+  DIRTY_MILD_DRY = 1 << 9,
+  DIRTY_COMMAND_LATENCY = 1 << 10,
+  DIRTY_LINK = 1 << 11,
+};
+
+/*
+ * The climate fields as last published, to tell whether a scheduled publish changes anything
+ */
+struct PublishedClimate {
+  climate::ClimateMode mode{climate::CLIMATE_MODE_OFF};
+  climate::ClimateAction action{climate::CLIMATE_ACTION_OFF};
+  float current_temperature{NAN};
+  float target_temperature{NAN};
+  optional<climate::ClimateFanMode> fan_mode;
+  climate::ClimateSwingMode swing_mode{climate::CLIMATE_SWING_OFF};
+  optional<climate::ClimatePreset> preset;
+  optional<std::string> custom_preset;
+  bool valid{false};  // Set once the climate has been published for the first time
+};
+
 enum class ACType {
   DNSKP11,  // New module (via CN-WLAN)
   CZTACG1   // Old module (via CN-CNT)
@@ -44,11 +105,32 @@ class PanasonicAC : public Component, public uart::UARTDevice, public climate::C
 
   void set_current_temperature_sensor(sensor::Sensor *current_temperature_sensor);
 
+  void set_command_latency_p50_sensor(sensor::Sensor *sensor) { this->command_latency_p50_sensor_ = sensor; }
+  void set_command_latency_p95_sensor(sensor::Sensor *sensor) { this->command_latency_p95_sensor_ = sensor; }
+  void set_command_latency_max_sensor(sensor::Sensor *sensor) { this->command_latency_max_sensor_ = sensor; }
+  void set_link_sensor(LinkCounter counter, sensor::Sensor *sensor) { this->link_sensors_[counter] = sensor; }
+  void set_trace_freeze_on_error(bool freeze) { this->trace_freeze_on_error_ = freeze; }
+
   void set_vertical_swing_enable(bool enable) { this->vertical_swing_enable_ = enable; }
   void set_horizontal_swing_enable(bool enable) { this->horizontal_swing_enable_ = enable; }
 
   void setup() override;
   void loop() override;
+  void dump_config() override;
+
+  void dump_latency();
+  void dump_link_stats();
+  void dump_trace();
+  void resume_trace();
+
+  uint32_t get_publishes() const { return this->publishes_; }
+  uint32_t get_publishes_suppressed() const { return this->publishes_suppressed_; }
+  uint32_t get_frames_unchanged() const { return this->frames_unchanged_; }
+  const LinkStats &get_link_stats() const { return this->link_; }
+  const LatencyHistogram &get_transmit_latency() const { return this->transmit_latency_; }
+  const LatencyHistogram &get_ack_latency() const { return this->ack_latency_; }
+  const LatencyHistogram &get_confirm_latency() const { return this->confirm_latency_; }
+  uint32_t get_commands_unconfirmed() const { return this->commands_unconfirmed_; }
 
  protected:
   sensor::Sensor *outside_temperature_sensor_ = nullptr;        // Sensor to store outside temperature from queries
@@ -61,24 +143,59 @@ class PanasonicAC : public Component, public uart::UARTDevice, public climate::C
   switch_::Switch *mild_dry_switch_ = nullptr;                  // Switch to toggle mild dry mode on/off
   sensor::Sensor *current_temperature_sensor_ = nullptr;        // Sensor to use for current temperature where AC does not report
   sensor::Sensor *current_power_consumption_sensor_ = nullptr;  // Sensor to store current power consumption from queries
+  sensor::Sensor *command_latency_p50_sensor_ = nullptr;        // Sensor for the median time until commands are confirmed
+  sensor::Sensor *command_latency_p95_sensor_ = nullptr;        // Sensor for the 95th percentile of that time
+  sensor::Sensor *command_latency_max_sensor_ = nullptr;        // Sensor for the longest time a command took
+  sensor::Sensor *link_sensors_[LINK_COUNTER_COUNT]{};           // Sensors for the link counters, per minute
 
-  std::string vertical_swing_state_;
-  std::string horizontal_swing_state_;
+  const char *vertical_swing_state_ = "";    // Label of the vertical swing position, points into a field table
+  const char *horizontal_swing_state_ = "";  // Label of the horizontal swing position, points into a field table
 
   bool nanoex_state_ = false;    // Stores the state of nanoex to prevent duplicate packets
   bool eco_state_ = false;       // Stores the state of eco to prevent duplicate packets
   bool econavi_state_ = false;       // Stores the state of econavi to prevent duplicate packets
   bool mild_dry_state_ = false;  // Stores the state of mild dry to prevent duplicate packets
 
+  float outside_temperature_state_ = NAN;  // Stores the outside temperature until it is published
+  float inside_temperature_state_ = NAN;   // Stores the inside temperature until it is published
+  float power_consumption_state_ = NAN;    // Stores the power consumption until it is published
+
+  uint16_t dirty_ = 0;                   // DirtyFlag bits of the entities that changed since the last publish
+  PublishedClimate published_climate_;  // The climate fields as last published
+  uint32_t publishes_ = 0;              // Number of state publishes over all entities
+  uint32_t publishes_suppressed_ = 0;   // Number of publishes skipped because they were merged or changed nothing
+  uint32_t frames_unchanged_ = 0;       // Number of state frames skipped without decoding, they matched the last one
+
   bool vertical_swing_enable_{false};
   bool horizontal_swing_enable_{false};
 
   bool waiting_for_response_ = false;  // Set to true if we are waiting for a response
 
-  // uint8_t receive_buffer_index = 0;     // Current position of the receive buffer
-  // uint8_t receive_buffer[BUFFER_SIZE];  // Stores the packet currently being received
+  RingBuffer<RX_RING_SIZE> rx_ring_;         // Stores bytes read from the UART until they are parsed
+  PacketBuffer<BUFFER_SIZE> rx_buffer_;      // Stores the packet currently being received or handled
+  PacketBuffer<RX_RING_SIZE> rx_resync_;     // Stores bytes of a rejected packet that need to be parsed again
+  size_t rx_resync_index_ = 0;               // Position of the next byte to parse again
+  size_t rx_expected_length_ = 0;            // Length of the packet being received, 0 if not known yet
+  uint8_t rx_checksum_ = 0;                  // Running sum of the packet being received
+  bool rx_packet_ready_ = false;             // Set to true while rx_buffer_ holds a complete packet
+
+  FrameQueue<TX_QUEUE_SIZE, TX_FIFO_SIZE> tx_queue_;  // Stores frames until the line is free to write them
+  uint32_t tx_frame_gap_ = 0;    // Minimum idle time (us) between two frames, set by the protocol
+  uint32_t tx_written_at_ = 0;   // Time (us) at which the last frame was written
+  uint32_t tx_busy_time_ = 0;    // Time (us) the last frame takes to leave the UART, plus the frame gap
+
+  LinkStats link_;  // Counters of the UART link, see LinkCounter
+  TraceRing<TRACE_SIZE> trace_;         // The last frames sent and received, filled by log_packet()
+  bool trace_freeze_on_error_ = false;  // Whether to stop tracing on the first link error
 
-  std::vector<uint8_t> rx_buffer_;
+  CommandStage command_stage_ = CommandStage::Idle;  // Stage of the last command
+  uint32_t command_queued_at_ = 0;       // Time at which the last command was requested
+  uint32_t command_transmitted_at_ = 0;  // Time at which the last command was written
+  bool command_timed_out_ = false;       // Set if a value requested by the last command was never reported
+  LatencyHistogram transmit_latency_;    // Time from the request of a command to writing it
+  LatencyHistogram ack_latency_;         // Time from writing a command to the AC answering it
+  LatencyHistogram confirm_latency_;     // Time from the request of a command to the AC reporting all of its values
+  uint32_t commands_unconfirmed_ = 0;    // Number of commands with a requested value that was never reported
 
   uint32_t init_time_;             // Stores the current time
   uint32_t last_read_;             // Stores the time at which the last read was done
@@ -88,19 +205,41 @@ class PanasonicAC : public Component, public uart::UARTDevice, public climate::C
   climate::ClimateTraits traits() override;
 
   void read_data();
+  bool read_packet();
+  bool next_byte(uint8_t *byte);
+  void resync_packet();
+  void reset_packet();
+
+  virtual bool is_packet_header(uint8_t byte) = 0;  // Whether a packet can start with this byte
+  virtual size_t packet_length() = 0;  // Total length of the packet in rx_buffer_, 0 if not known yet
+
+  bool queue_frame(const uint8_t *data, size_t length, CommandType type, TxPriority priority);
+  void handle_tx();
+  // Called right before a queued frame is written
+  virtual void prepare_frame(uint8_t * /*data*/, size_t /*length*/, CommandType /*type*/) {}
 
   void update_outside_temperature(int8_t temperature);
   void update_inside_temperature(int8_t temperature);
   void update_current_temperature(int8_t temperature);
   void update_target_temperature(uint8_t raw_value);
-  void update_swing_horizontal(const std::string &swing);
-  void update_swing_vertical(const std::string &swing);
+  void update_swing_horizontal(const char *swing);
+  void update_swing_vertical(const char *swing);
   void update_nanoex(bool nanoex);
   void update_eco(bool eco);
   void update_econavi(bool econavi);
   void update_mild_dry(bool mild_dry);
   void update_current_power_consumption(int16_t power);
 
+  void command_queued();
+  void command_transmitted();
+  void command_acknowledged();
+  void command_settled();
+  void command_dropped();
+
+  void schedule_publish();
+  void publish_pending();
+  bool climate_changed() const;
+
   virtual void on_horizontal_swing_change(const std::string &swing) = 0;
   virtual void on_vertical_swing_change(const std::string &swing) = 0;
   virtual void on_nanoex_change(bool nanoex) = 0;
@@ -110,7 +249,15 @@ class PanasonicAC : public Component, public uart::UARTDevice, public climate::C
 
   climate::ClimateAction determine_action();
 
-  void log_packet(std::vector<uint8_t> data, bool outgoing = false);
+  void link_error(LinkCounter counter, uint32_t n = 1);
+
+  void log_packet(const uint8_t *data, size_t length, bool outgoing = false);
+  void log_packet(const std::vector<uint8_t> &data, bool outgoing = false) {
+    this->log_packet(data.data(), data.size(), outgoing);
+  }
+  template<size_t N> void log_packet(const PacketBuffer<N> &data, bool outgoing = false) {
+    this->log_packet(data.data(), data.size(), outgoing);
+  }
 };
 
 }  // namespace panasonic_ac
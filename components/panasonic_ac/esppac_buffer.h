@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace panasonic_ac {
+
+/*
+ * Fixed-capacity linear buffer holding a single packet
+ */
+template<size_t N> class PacketBuffer {
+ public:
+  uint8_t *data() { return this->data_; }
+  const uint8_t *data() const { return this->data_; }
+  size_t size() const { return this->length_; }
+  bool empty() const { return this->length_ == 0; }
+  bool full() const { return this->length_ >= N; }
+  static constexpr size_t capacity() { return N; }
+
+  uint8_t &operator[](size_t index) { return this->data_[index]; }
+  const uint8_t &operator[](size_t index) const { return this->data_[index]; }
+
+  const uint8_t *begin() const { return this->data_; }
+  const uint8_t *end() const { return this->data_ + this->length_; }
+
+  void clear() { this->length_ = 0; }
+
+  // Returns false (and drops the byte) if the buffer is full
+  bool push_back(uint8_t byte) {
+    if (this->length_ >= N)
+      return false;
+
+    this->data_[this->length_++] = byte;
+    return true;
+  }
+
+ protected:
+  uint8_t data_[N];
+  size_t length_ = 0;
+};
+
+/*
+ * Fixed-capacity single producer/single consumer byte ring, N must be a power of two
+ */
+template<size_t N> class RingBuffer {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "Ring buffer capacity must be a power of two");
+
+ public:
+  size_t size() const { return this->head_ - this->tail_; }
+  size_t free() const { return N - this->size(); }
+  bool empty() const { return this->head_ == this->tail_; }
+  bool full() const { return this->size() == N; }
+  static constexpr size_t capacity() { return N; }
+
+  // Byte at the given position counted from the oldest byte in the ring
+  uint8_t peek(size_t index) const { return this->data_[(this->tail_ + index) & MASK]; }
+
+  // Returns the contiguous free region at the write position, clamping length to its size
+  uint8_t *write_span(size_t *length) {
+    size_t head = this->head_ & MASK;
+    size_t contiguous = N - head;
+    size_t free = this->free();
+
+    if (contiguous > free)
+      contiguous = free;
+    if (*length > contiguous)
+      *length = contiguous;
+
+    return this->data_ + head;
+  }
+
+  // Publishes bytes written into the region returned by write_span()
+  void commit(size_t length) { this->head_ += length; }
+
+  bool pop(uint8_t *byte) {
+    if (this->empty())
+      return false;
+
+    *byte = this->data_[this->tail_ & MASK];
+    this->tail_++;
+    return true;
+  }
+
+  void clear() { this->tail_ = this->head_; }
+
+ protected:
+  static constexpr size_t MASK = N - 1;
+
+  uint8_t data_[N];
+  size_t head_ = 0;  // Free-running write index
+  size_t tail_ = 0;  // Free-running read index
+};
+
+/*
+ * Fixed-capacity queue of Frames packets of up to FrameSize bytes
+ *
+ * front() is the oldest packet of the lowest priority value, so packets of the same priority leave in order.
+ */
+template<size_t Frames, size_t FrameSize> class FrameQueue {
+ public:
+  struct Entry {
+    PacketBuffer<FrameSize> packet;
+    uint8_t priority;  // Lower values leave first
+    uint8_t tag;       // Left to the user, e.g. the type of the packet
+    uint32_t order;    // Sequence number, keeps packets of the same priority in order
+  };
+
+  size_t size() const { return this->size_; }
+  bool empty() const { return this->size_ == 0; }
+  bool full() const { return this->size_ >= Frames; }
+
+  // Returns false (and drops the packet) if the queue is full or the packet too long
+  bool push(const uint8_t *data, size_t length, uint8_t priority, uint8_t tag) {
+    if (this->full() || length > FrameSize)
+      return false;
+
+    for (Entry &entry : this->entries_) {
+      if (!entry.packet.empty())
+        continue;
+
+      for (size_t i = 0; i < length; i++)
+        entry.packet.push_back(data[i]);
+      entry.priority = priority;
+      entry.tag = tag;
+      entry.order = this->next_order_++;
+      this->size_++;
+      return true;
+    }
+
+    return false;
+  }
+
+  // The packet to send next, nullptr if the queue is empty
+  Entry *front() {
+    Entry *front = nullptr;
+
+    for (Entry &entry : this->entries_) {
+      if (entry.packet.empty())
+        continue;
+      if (front == nullptr || entry.priority < front->priority ||
+          (entry.priority == front->priority && (int32_t) (entry.order - front->order) < 0))
+        front = &entry;
+    }
+
+    return front;
+  }
+
+  void pop() {
+    Entry *front = this->front();
+    if (front == nullptr)
+      return;
+
+    front->packet.clear();
+    this->size_--;
+  }
+
+  void clear() {
+    for (Entry &entry : this->entries_)
+      entry.packet.clear();
+    this->size_ = 0;
+  }
+
+ protected:
+  Entry entries_[Frames];  // Slots with an empty packet are free
+  size_t size_ = 0;
+  uint32_t next_order_ = 0;
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
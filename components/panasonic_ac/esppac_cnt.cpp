@@ -13,28 +13,79 @@ void PanasonicACCNT::setup() {
   ESP_LOGD(TAG, "Using CZ-TACG1 protocol via CN-CNT");
   ESP_LOGD(TAG, "horizontal_swing_enable: %s", this->horizontal_swing_enable_ ? "true" : "false");
   ESP_LOGD(TAG, "vertical_swing_enable: %s", this->vertical_swing_enable_ ? "true" : "false");
+  ESP_LOGD(TAG, "poll_interval: %u - %u ms", (unsigned) this->poll_interval_min_,
+           (unsigned) this->poll_interval_max_);
+
+  // The state confirmed before a restart is published right away, the first poll answer replaces it. Keys include the
+  // entity so several climates on one node keep their own
+  this->cache_pref_ = global_preferences->make_preference<StateBlockData>(
+      fnv1_hash("panasonic_ac_cnt_state") ^ this->get_object_id_hash(), true);
+
+  if (this->cache_pref_.load(&this->cached_)) {
+    ESP_LOGD(TAG, "Restored cached state");
+    this->data = this->cached_;
+    this->set_data(false);
+    this->schedule_publish();
+    this->state_ = ACState::Cached;
+  }
+
+  // The energy totals carry on after a restart, the time the module was down is not counted
+  if (this->has_energy_sensors()) {
+    this->energy_pref_ = global_preferences->make_preference<EnergyData>(
+        fnv1_hash("panasonic_ac_cnt_energy") ^ this->get_object_id_hash(), true);
+
+    // Steady polls back off to poll_interval_max_, the gap limit leaves room for a lost answer on top of that
+    this->energy_.set_gap_max(std::max(EnergyMeter::GAP_MAX_DEFAULT, 2 * this->poll_interval_max_));
+
+    if (this->energy_pref_.load(&this->energy_saved_)) {
+      this->energy_.restore(this->energy_saved_);
+      ESP_LOGD(TAG, "Restored energy total: %.3f kWh", EnergyMeter::to_kwh(this->energy_.total()));
+    }
+  }
+}
+
+void PanasonicACCNT::on_safe_shutdown() {
+  handle_cache(true);   // Store the latest confirmed state, whatever the time since the last write
+  handle_energy(true);  // Store the energy counted since the last write
+}
+
+void PanasonicACCNT::dump_config() {
+  PanasonicAC::dump_config();
+
+  if (this->has_energy_sensors())
+    this->dump_energy();
+}
+
+void PanasonicACCNT::set_poll_interval(uint32_t min, uint32_t max) {
+  this->poll_interval_min_ = min;
+  this->poll_interval_max_ = max < min ? min : max;
+  this->poll_interval_ = min;
 }
 
 void PanasonicACCNT::loop() {
   PanasonicAC::read_data();
 
-  if (millis() - this->last_read_ > READ_TIMEOUT &&
-      !this->rx_buffer_.empty())  // Check if our read timed out and we received something
+  while (read_packet())  // Handle every packet that was completed since the last loop
   {
     log_packet(this->rx_buffer_);
 
     if (!verify_packet())  // Verify length, header, counter and checksum
-      return;
+      continue;
 
     this->waiting_for_response_ = false;
     this->last_packet_received_ = millis();  // Set the time at which we received our last packet
 
     handle_packet();
-
-    this->rx_buffer_.clear();  // Reset buffer
   }
+
   handle_cmd();
   handle_poll();  // Handle sending poll packets
+  handle_tx();    // Write the next queued frame once the line is free
+
+  handle_cache(false);   // Write the confirmed state to flash once in a while
+  handle_energy(false);  // Write the energy totals to flash once in a while
+  publish_energy();
+  publish_pending();  // Publish what changed during this loop
 }
 
 /*
@@ -42,35 +93,37 @@ void PanasonicACCNT::loop() {
  */
 
 void PanasonicACCNT::control(const climate::ClimateCall &call) {
-  if (this->state_ != ACState::Ready)
+  if (this->state_ == ACState::Initializing)
     return;
 
-  if (this->cmd.empty()) {
-    ESP_LOGV(TAG, "Copying data to cmd: Main");
-    this->cmd = this->data;
-  }
+  StateBlockWriter cmd = edit_cmd();
 
   if (call.get_mode().has_value()) {
     ESP_LOGV(TAG, "Requested mode change");
 
     switch (*call.get_mode()) {
       case climate::CLIMATE_MODE_COOL:
-        this->cmd[0] = 0x34;
+        cmd.set_mode(0x03);
+        cmd.set_power(0x04);
         break;
       case climate::CLIMATE_MODE_HEAT:
-        this->cmd[0] = 0x44;
+        cmd.set_mode(0x04);
+        cmd.set_power(0x04);
         break;
       case climate::CLIMATE_MODE_DRY:
-        this->cmd[0] = 0x24;
+        cmd.set_mode(0x02);
+        cmd.set_power(0x04);
         break;
       case climate::CLIMATE_MODE_HEAT_COOL:
-        this->cmd[0] = 0x04;
+        cmd.set_mode(0x00);
+        cmd.set_power(0x04);
         break;
       case climate::CLIMATE_MODE_FAN_ONLY:
-        this->cmd[0] = 0x64;
+        cmd.set_mode(0x06);
+        cmd.set_power(0x04);
         break;
       case climate::CLIMATE_MODE_OFF:
-        this->cmd[0] = this->cmd[0] & 0xF0;  // Strip right nib to turn AC off
+        cmd.set_power(0x00);  // Keep the mode, only turn AC off
         break;
       default:
         ESP_LOGV(TAG, "Unsupported mode requested");
@@ -80,38 +133,38 @@ void PanasonicACCNT::control(const climate::ClimateCall &call) {
 
   if (call.get_target_temperature().has_value()) {
     ESP_LOGV(TAG, "Requested temperature change");
-    this->cmd[1] = *call.get_target_temperature() / TEMPERATURE_STEP;
+    cmd.set_target_temperature(*call.get_target_temperature() / TEMPERATURE_STEP);
   }
   
   if (call.get_fan_mode().has_value()) {
     ESP_LOGV(TAG, "Requested fan mode change");
 
     if (*call.get_fan_mode() == climate::CLIMATE_FAN_QUIET) {
-      this->cmd[3] = 0xA0; // Set fan to Auto for Quiet mode
-      this->cmd[5] = (this->cmd[5] & 0xF0) + 0x04; // Set Quiet bit in byte 5
+      cmd.set_fan_speed(0xA0); // Set fan to Auto for Quiet mode
+      cmd.set_preset(0x04); // Set Quiet preset
     } else {
-      // Clear the Quiet bit (0x04) in byte 5 when a non-Quiet fan mode is selected.
-      // Preserve other bits (like 0x02 for Boost) if they are set in byte 5.
-      this->cmd[5] = this->cmd[5] & (~0x04); 
-      
+      // Clear the Quiet bit (0x04) of the preset when a non-Quiet fan mode is selected.
+      // Preserve other bits (like 0x02 for Boost) if they are set.
+      cmd.set_preset(cmd.preset() & ~0x04);
+
       switch (*call.get_fan_mode()) {
         case climate::CLIMATE_FAN_AUTO:
-          this->cmd[3] = 0xA0;
+          cmd.set_fan_speed(0xA0);
           break;
         case climate::CLIMATE_FAN_DIFFUSE:
-          this->cmd[3] = 0x30;
+          cmd.set_fan_speed(0x30);
           break;
         case climate::CLIMATE_FAN_LOW:
-          this->cmd[3] = 0x40;
+          cmd.set_fan_speed(0x40);
           break;
         case climate::CLIMATE_FAN_MEDIUM:
-          this->cmd[3] = 0x50;
+          cmd.set_fan_speed(0x50);
           break;
         case climate::CLIMATE_FAN_HIGH:
-          this->cmd[3] = 0x60;
+          cmd.set_fan_speed(0x60);
           break;
         case climate::CLIMATE_FAN_FOCUS:
-          this->cmd[3] = 0x70;
+          cmd.set_fan_speed(0x70);
           break;
         default:
           ESP_LOGW(TAG, "Unsupported fan mode requested");
@@ -125,16 +178,20 @@ void PanasonicACCNT::control(const climate::ClimateCall &call) {
 
     switch (*call.get_swing_mode()) {
       case climate::CLIMATE_SWING_BOTH:
-        this->cmd[4] = 0xFD;  // Vertical: Swing, Horizontal: Swing
+        cmd.set_vertical_swing(VERTICAL_SWING.encode(VerticalSwing::Swing));
+        cmd.set_horizontal_swing(HORIZONTAL_SWING.encode(HorizontalSwing::Swing));
         break;
       case climate::CLIMATE_SWING_OFF:
-        this->cmd[4] = 0x36;  // Vertical: Middle, Horizontal: Center
+        cmd.set_vertical_swing(VERTICAL_SWING.encode(VerticalSwing::Middle));
+        cmd.set_horizontal_swing(HORIZONTAL_SWING.encode(HorizontalSwing::Center));
         break;
       case climate::CLIMATE_SWING_VERTICAL:
-        this->cmd[4] = 0xE6;  // Vertical: swing, Horizontal: Center
+        cmd.set_vertical_swing(VERTICAL_SWING.encode(VerticalSwing::Swing));
+        cmd.set_horizontal_swing(HORIZONTAL_SWING.encode(HorizontalSwing::Center));
         break;
       case climate::CLIMATE_SWING_HORIZONTAL:
-        this->cmd[4] = 0x3D;  // Vertical: Middle, Horizontal: Swing
+        cmd.set_vertical_swing(VERTICAL_SWING.encode(VerticalSwing::Middle));
+        cmd.set_horizontal_swing(HORIZONTAL_SWING.encode(HorizontalSwing::Swing));
         break;
       default:
         ESP_LOGW(TAG, "Unsupported swing mode requested");
@@ -144,104 +201,98 @@ void PanasonicACCNT::control(const climate::ClimateCall &call) {
 
   if (call.get_preset().has_value()) {
     ESP_LOGV(TAG, "Requested preset change");
-    this->cmd[3] = 0xA0; // Set fan mode to Auto (0xA0)
+    cmd.set_fan_speed(0xA0); // Set fan mode to Auto (0xA0)
     switch (*call.get_preset()) {
       case climate::CLIMATE_PRESET_NONE:
-        this->cmd[5] = (this->cmd[5] & 0xF0); // Clear right nibble of byte 5 (including Boost and Quiet)
-        this->cmd[8] = 0x00; // Turn eco OFF
-        this->preset = climate::CLIMATE_PRESET_NONE; // Optimistic update
+        cmd.set_preset(0x00); // Clear the preset (including Boost and Quiet)
+        cmd.set_eco(0x00); // Turn eco OFF
         break;
       case climate::CLIMATE_PRESET_BOOST:
-        this->cmd[5] = (this->cmd[5] & 0xF0) + 0x02; // Set right nibble of byte 5 to Boost
-        this->cmd[8] = 0x00; // Turn eco OFF
-        this->preset = climate::CLIMATE_PRESET_BOOST; // Optimistic update
+        cmd.set_preset(0x02); // Set the preset to Boost
+        cmd.set_eco(0x00); // Turn eco OFF
         break;
       case climate::CLIMATE_PRESET_ECO:
-        this->cmd[5] = (this->cmd[5] & 0xF0); // Clear right nibble of byte 5 (including Boost and Quiet)
-        this->cmd[8] = 0x40; // Turn eco ON
-        this->preset = climate::CLIMATE_PRESET_ECO; // Optimistic update
+        cmd.set_preset(0x00); // Clear the preset (including Boost and Quiet)
+        cmd.set_eco(0x40); // Turn eco ON
         break;
       default:
         ESP_LOGW(TAG, "Unsupported preset requested");
         break;
     }
-    this->publish_state(); // Publish the climate component's state to reflect the optimistic preset
-
-    // If Eco or None (from Eco) preset is involved, activate suppression
-    if (*call.get_preset() == climate::CLIMATE_PRESET_ECO || *call.get_preset() == climate::CLIMATE_PRESET_NONE) {
-      this->suppress_poll_update_for_eco_preset_ = true;
-      this->suppress_poll_timeout_ = millis() + SUPPRESSION_DURATION_MS;
-    }
   }
 }
 
 /*
- * Set the data array to the fields
+ * Set the fields from a state block, usually the data array
  */
-void PanasonicACCNT::set_data(bool set) {
-  this->mode = determine_mode(this->data[0]);
-  this->fan_mode = determine_fan_mode(this->data[3]); // determine_fan_mode now considers data[5]
-  this->preset = determine_preset(this->data[5]); // determine_preset no longer considers 0x04 for Sleep
-
-  std::string verticalSwing = determine_vertical_swing(this->data[4]);
-  std::string horizontalSwing = determine_horizontal_swing(this->data[4]);
-
-  bool nanoex = determine_preset_nanoex(this->data[5]);
-  bool eco = determine_eco(this->data[8]);
-  bool econavi = determine_econavi(this->data[5]);
-  bool mildDry = determine_mild_dry(this->data[2]);
+void PanasonicACCNT::set_data(bool set, const StateBlockData &block) {
+  StateBlock data = StateBlock::view(block);
+
+  this->mode = determine_mode(data.mode(), data.power());
+  this->fan_mode = determine_fan_mode(data.fan_speed(), data.preset()); // determine_fan_mode now considers the preset
+  this->preset = determine_preset(data.preset(), data.eco()); // determine_preset no longer considers 0x04 for Sleep
+
+  VerticalSwing verticalSwing = determine_vertical_swing(data.vertical_swing());
+  HorizontalSwing horizontalSwing = determine_horizontal_swing(data.horizontal_swing());
+
+  bool nanoex = data.nanoex();
+  bool eco = determine_eco(data.eco());
+  bool econavi = data.econavi();
+  bool mildDry = determine_mild_dry(data.mild_dry());
   
-  this->update_target_temperature((int8_t) this->data[1]);
+  this->update_target_temperature((int8_t) data.target_temperature());
 
-  if (set) {
+  PollResponse poll;
+
+  if (set && PollResponse::wrap(this->rx_buffer_.data(), this->rx_buffer_.size(), &poll)) {
     // Also set current and outside temperature
     // 128 means not supported
     if (this->current_temperature_sensor_ == nullptr) {
-      if(this->rx_buffer_[18] != 0x80)
-        this->update_current_temperature((int8_t)this->rx_buffer_[18]);
-      else if(this->rx_buffer_[21] != 0x80)
-        this->update_current_temperature((int8_t)this->rx_buffer_[21]);
+      if(poll.inside_temperature() != TEMPERATURE_UNSUPPORTED)
+        this->update_current_temperature(poll.inside_temperature());
+      else if(poll.inside_temperature_alt() != TEMPERATURE_UNSUPPORTED)
+        this->update_current_temperature(poll.inside_temperature_alt());
       else
         ESP_LOGV(TAG, "Current temperature is not supported");
     }
 
     if (this->outside_temperature_sensor_ != nullptr)
     {
-      if(this->rx_buffer_[19] != 0x80)
-        this->update_outside_temperature((int8_t)this->rx_buffer_[19]);
-      else if(this->rx_buffer_[22] != 0x80)
-        this->update_outside_temperature((int8_t)this->rx_buffer_[22]);
+      if(poll.outside_temperature() != TEMPERATURE_UNSUPPORTED)
+        this->update_outside_temperature(poll.outside_temperature());
+      else if(poll.outside_temperature_alt() != TEMPERATURE_UNSUPPORTED)
+        this->update_outside_temperature(poll.outside_temperature_alt());
       else
         ESP_LOGV(TAG, "Outside temperature is not supported");
     }
 
     if (this->inside_temperature_sensor_ != nullptr)
     {
-      if(this->rx_buffer_[18] != 0x80)
-        this->update_inside_temperature((int8_t)this->rx_buffer_[18]);
-      else if(this->rx_buffer_[21] != 0x80)
-        this->update_inside_temperature((int8_t)this->rx_buffer_[21]);
+      if(poll.inside_temperature() != TEMPERATURE_UNSUPPORTED)
+        this->update_inside_temperature(poll.inside_temperature());
+      else if(poll.inside_temperature_alt() != TEMPERATURE_UNSUPPORTED)
+        this->update_inside_temperature(poll.inside_temperature_alt());
       else
         ESP_LOGV(TAG, "Inside temperature is not supported");
     }
 
     if(this->current_power_consumption_sensor_ != nullptr) {
-      uint16_t power_consumption = determine_power_consumption((int8_t)this->rx_buffer_[28], (int8_t)this->rx_buffer_[29], (int8_t)this->rx_buffer_[30]);
+      uint16_t power_consumption = determine_power_consumption(poll.power(), poll.power_offset());
       this->update_current_power_consumption(power_consumption);
     }
   }
 
-  if (verticalSwing == "Swing" && horizontalSwing == "Swing")
+  if (verticalSwing == VerticalSwing::Swing && horizontalSwing == HorizontalSwing::Swing)
     this->swing_mode = climate::CLIMATE_SWING_BOTH;
-  else if (verticalSwing == "Swing")
+  else if (verticalSwing == VerticalSwing::Swing)
     this->swing_mode = climate::CLIMATE_SWING_VERTICAL;
-  else if (horizontalSwing == "Swing")
+  else if (horizontalSwing == HorizontalSwing::Swing)
     this->swing_mode = climate::CLIMATE_SWING_HORIZONTAL;
   else
     this->swing_mode = climate::CLIMATE_SWING_OFF;
 
-  this->update_swing_vertical(verticalSwing);
-  this->update_swing_horizontal(horizontalSwing);
+  this->update_swing_vertical(VERTICAL_SWING.label(verticalSwing));
+  this->update_swing_horizontal(HORIZONTAL_SWING.label(horizontalSwing));
 
   this->update_nanoex(nanoex);
   this->update_eco(eco);
@@ -252,32 +303,42 @@ void PanasonicACCNT::set_data(bool set) {
 /*
  * Send a command, attaching header, packet length and checksum
  */
-void PanasonicACCNT::send_command(std::vector<uint8_t> command, CommandType type, uint8_t header = CNT::CTRL_HEADER) {
-  uint8_t length = command.size();
-  command.insert(command.begin(), header);
-  command.insert(command.begin() + 1, length);
+bool PanasonicACCNT::send_command(const uint8_t *command, size_t length, CommandType type,
+                                  uint8_t header = CNT::CTRL_HEADER) {
+  if (length > COMMAND_MAX_LENGTH) {
+    ESP_LOGE(TAG, "Command is too long to send");
+    return false;
+  }
+
+  uint8_t packet[COMMAND_MAX_LENGTH + 3];  // Header, packet length, command and checksum
+  packet[0] = header;
+  packet[1] = length;
+  std::memcpy(packet + 2, command, length);
 
   uint8_t checksum = 0;
 
-  for (uint8_t i : command)
-    checksum -= i;  // Add to checksum
+  for (size_t i = 0; i < length + 2; i++)
+    checksum -= packet[i];  // Add to checksum
 
-  command.push_back(checksum);
+  packet[length + 2] = checksum;
 
-  send_packet(command, type);  // Actually send the constructed packet
+  return send_packet(packet, length + 3, type);  // Actually send the constructed packet
 }
 
 /*
- * Send a raw packet, as is
+ * Queue a raw packet, as is, polls leave after anything else that is waiting
  */
-void PanasonicACCNT::send_packet(const std::vector<uint8_t> &packet, CommandType type) {
-  this->last_packet_sent_ = millis();  // Save the time when we sent the last packet
+bool PanasonicACCNT::send_packet(const uint8_t *packet, size_t length, CommandType type) {
+  TxPriority priority = packet[0] == POLL_HEADER ? TxPriority::Poll : TxPriority::Command;
+  return queue_frame(packet, length, type, priority);
+}
+
+void PanasonicACCNT::prepare_frame(uint8_t *data, size_t /*length*/, CommandType type) {
+  if (data[0] == CTRL_HEADER)
+    this->command_transmitted();
 
   if (type != CommandType::Response)     // Don't wait for a response for responses
     this->waiting_for_response_ = true;  // Mark that we are waiting for a response
-
-  write_array(packet);       // Write to UART
-  log_packet(packet, true);  // Write to log
 }
 
 /*
@@ -285,27 +346,281 @@ void PanasonicACCNT::send_packet(const std::vector<uint8_t> &packet, CommandType
  */
 
 void PanasonicACCNT::handle_poll() {
-  if (millis() - this->last_packet_sent_ > POLL_INTERVAL) {
+  if ((this->cmd_pending_ && this->state_ == ACState::Ready) || !this->tx_queue_.empty())
+    return;  // Pending commands go first, the poll after them shows their result
+
+  // Poll quickly until the state is known and until the last command shows up in the polled data, otherwise at the
+  // adaptive interval
+  uint32_t interval = this->state_ != ACState::Ready || this->intents_.any_pending() ? CONFIRM_POLL_DELAY
+                                                                                     : this->poll_interval_;
+
+  if (millis() - this->last_packet_sent_ > interval) {
     ESP_LOGV(TAG, "Polling AC");
-    send_command(CMD_POLL, CommandType::Normal, POLL_HEADER);
+    send_command(CMD_POLL, sizeof(CMD_POLL), CommandType::Normal, POLL_HEADER);
+  }
+}
+
+/*
+ * Poll at the minimum interval while the state changes and double the interval up to the maximum while it doesn't
+ */
+void PanasonicACCNT::update_poll_interval(const PollResponse &poll) {
+  bool changed = this->polled_data_ != this->data;
+
+  // Inside and outside temperature, as read by set_data()
+  const int8_t temperatures[4] = {poll.inside_temperature(), poll.outside_temperature(), poll.inside_temperature_alt(),
+                                  poll.outside_temperature_alt()};
+  for (size_t i = 0; i < 4; i++) {
+    if (temperatures[i] != this->last_poll_temperatures_[i]) {
+      this->last_poll_temperatures_[i] = temperatures[i];
+      changed = true;
+    }
+  }
+
+  // Small fluctuations in power consumption are ignored, the reference only moves once the change is large enough
+  uint16_t power = determine_power_consumption(poll.power(), poll.power_offset());
+  if (abs((int) power - (int) this->last_poll_power_) >= POLL_POWER_DELTA) {
+    this->last_poll_power_ = power;
+    changed = true;
   }
+
+  set_poll_interval_changed(changed);
+}
+
+void PanasonicACCNT::set_poll_interval_changed(bool changed) {
+  uint32_t interval = changed ? this->poll_interval_min_ : std::min(this->poll_interval_ * 2, this->poll_interval_max_);
+
+  if (interval != this->poll_interval_)
+    ESP_LOGV(TAG, "Poll interval: %u ms", (unsigned) interval);
+
+  this->poll_interval_ = interval;
 }
 
 void PanasonicACCNT::handle_cmd() {
-  if (!this->cmd.empty() && millis() - this->last_packet_sent_ > CMD_INTERVAL) {
-    ESP_LOGV(TAG, "Sending Command");
-    send_command(this->cmd, CommandType::Normal, CTRL_HEADER);
-    this->cmd.clear();
+  // Commands edited against the cached state wait for the first poll, which they are rebased onto
+  if (!this->cmd_pending_ || this->state_ != ACState::Ready || !this->tx_queue_.empty())
+    return;
+
+  // Wait for edits made in quick succession so they end up in the same frame, and keep the gap between frames
+  if (millis() - this->cmd_created_ < CMD_COALESCE_TIME || millis() - this->last_packet_sent_ <= CMD_INTERVAL)
+    return;
+
+  if (this->cmd == this->data) {
+    ESP_LOGV(TAG, "Dropping command, AC is already in the requested state");
+    this->commands_suppressed_++;
+    this->cmd_pending_ = false;
+    this->command_dropped();
+    return;
+  }
+
+  ESP_LOGV(TAG, "Sending Command");
+  if (!send_command(this->cmd.bytes, this->cmd.size(), CommandType::Normal, CTRL_HEADER))
+    return;  // Still pending, sent again on a later loop
+
+  this->cmd_pending_ = false;
+
+  // Every field the command changes is expected to show up in the polls, and is published as requested until then
+  for (size_t i = 0; i < StateBlock::FIELD_COUNT; i++) {
+    FieldMask field = StateBlock::FIELDS[i];
+    if (this->cmd.get(field) != this->data.get(field))
+      this->intents_.request(i, this->cmd.get(field), millis());
+  }
+
+  this->data = this->cmd;
+  this->set_data(false);
+  this->schedule_publish();
+}
+
+/*
+ * Start a command from the state the AC is expected to be in, or merge into the pending one, and return it for editing
+ */
+StateBlockWriter PanasonicACCNT::edit_cmd() {
+  if (this->cmd_pending_) {
+    this->commands_merged_++;
+  } else {
+    ESP_LOGV(TAG, "Copying data to cmd");
+    this->last_poll_valid_ = false;  // Optimistic updates may follow, the next poll has to be handled in full
+    this->cmd = this->data;
+    this->cmd_pending_ = true;
+    this->cmd_created_ = millis();
+    this->command_queued();
+    this->poll_interval_ = this->poll_interval_min_;  // Expect changes while the AC is being controlled
+  }
+
+  return StateBlockWriter::edit(this->cmd);
+}
+
+/*
+ * Whether the received poll response equals the one the data was taken from, so handling it would change nothing
+ *
+ * Pending or unconfirmed commands and optimistic updates need the full handling, they compare against the poll.
+ */
+bool PanasonicACCNT::is_unchanged_poll() {
+  if (!this->last_poll_valid_ || this->cmd_pending_ || this->intents_.any_pending())
+    return false;
+
+  return this->last_poll_.equals(this->rx_buffer_.data(), this->rx_buffer_.size());
+}
+
+/*
+ * Replace polled fields that contradict a pending request by the requested value
+ */
+void PanasonicACCNT::reconcile_intents() {
+  uint32_t timed_out = this->intents_.get_timed_out();
+
+  for (size_t i = 0; i < StateBlock::FIELD_COUNT; i++) {
+    FieldMask field = StateBlock::FIELDS[i];
+    this->polled_data_.set(field, this->intents_.reconcile(i, this->polled_data_.get(field), millis()));
+  }
+
+  if (this->intents_.get_timed_out() != timed_out) {
+    ESP_LOGW(TAG, "AC did not apply %u requested field(s) in time",
+             (unsigned) (this->intents_.get_timed_out() - timed_out));
+    this->command_timed_out_ = true;
+  }
+}
+
+/*
+ * Move a command edited against the cached state onto the polled state, so fields changed while the module was down,
+ * for example with the remote, are not set back to their cached values
+ */
+void PanasonicACCNT::rebase_cmd() {
+  StateBlockData cmd = this->polled_data_;
+
+  for (size_t i = 0; i < StateBlock::FIELD_COUNT; i++) {
+    FieldMask field = StateBlock::FIELDS[i];
+    if (this->cmd.get(field) != this->data.get(field))
+      cmd.set(field, this->cmd.get(field));  // Edited since the command was started from the cached state
+  }
+
+  this->cmd = cmd;
+}
+
+/*
+ * Keep the state the AC confirmed in the cache, written at most once per CACHE_WRITE_INTERVAL to spare the flash
+ */
+void PanasonicACCNT::handle_cache(bool force) {
+  if (this->state_ != ACState::Ready || this->cmd_pending_ || this->intents_.any_pending())
+    return;  // Only states the AC confirmed are cached
+
+  if (this->data == this->cached_)
+    return;
+
+  if (!force && this->cache_writes_ > 0 && millis() - this->cache_written_ < CACHE_WRITE_INTERVAL)
+    return;
+
+  ESP_LOGV(TAG, "Writing state cache");
+  this->cache_pref_.save(&this->data);
+  this->cached_ = this->data;
+  this->cache_written_ = millis();
+  this->cache_writes_++;
+}
+
+/*
+ * Energy metering
+ */
+
+bool PanasonicACCNT::has_energy_sensors() const {
+  return this->energy_total_sensor_ != nullptr || this->energy_hour_sensor_ != nullptr ||
+         this->energy_day_sensor_ != nullptr;
+}
+
+// Keep the energy totals in flash, written at most once per ENERGY_WRITE_INTERVAL to spare the flash
+void PanasonicACCNT::handle_energy(bool force) {
+  if (!this->has_energy_sensors())
+    return;
+
+  if (!force && millis() - this->energy_written_ < ENERGY_WRITE_INTERVAL)
+    return;
+
+  // Any sample since the last write moved the total or the time into the current hour
+  const EnergyData &data = this->energy_.data();
+  if (data.total == this->energy_saved_.total && data.hour_elapsed == this->energy_saved_.hour_elapsed)
+    return;
+
+  ESP_LOGV(TAG, "Writing energy totals");
+  this->energy_pref_.save(&data);
+  this->energy_saved_ = data;
+  this->energy_written_ = millis();
+  this->energy_writes_++;
+}
+
+// Publish the energy sensors once per ENERGY_PUBLISH_INTERVAL at most, once the total moved by a Wh or an hour ended
+void PanasonicACCNT::publish_energy() {
+  if (!this->has_energy_sensors())
+    return;
+
+  uint64_t wh = this->energy_.total() / ENERGY_MJ_PER_WH;
+  if (wh == this->energy_published_ && this->energy_.hours_closed() == this->energy_published_hours_)
+    return;
+
+  if (this->energy_published_ != UINT64_MAX && millis() - this->energy_publish_time_ < ENERGY_PUBLISH_INTERVAL)
+    return;
+
+  if (this->energy_total_sensor_ != nullptr) {
+    this->energy_total_sensor_->publish_state(EnergyMeter::to_kwh(this->energy_.total()));
+    this->publishes_++;
+  }
+
+  if (this->energy_hour_sensor_ != nullptr) {
+    this->energy_hour_sensor_->publish_state(EnergyMeter::to_kwh(this->energy_.hour()));
+    this->publishes_++;
+  }
+
+  if (this->energy_day_sensor_ != nullptr) {
+    this->energy_day_sensor_->publish_state(EnergyMeter::to_kwh(this->energy_.day()));
+    this->publishes_++;
   }
+
+  this->energy_published_ = wh;
+  this->energy_published_hours_ = this->energy_.hours_closed();
+  this->energy_publish_time_ = millis();
+}
+
+void PanasonicACCNT::dump_energy() {
+  auto dump_buckets = [this](const char *name, size_t count, bool days) {
+    char line[ENERGY_HOURS * 11 + 1];  // A space and up to 10 digits per bucket
+    size_t length = 0;
+
+    for (size_t age = 0; age < count; age++) {
+      uint32_t wh = days ? this->energy_.last_day(age) : this->energy_.last_hour(age);
+      length += snprintf(line + length, sizeof(line) - length, " %u", (unsigned) wh);
+    }
+
+    ESP_LOGCONFIG(TAG, "  %-22s%s", name, line);
+  };
+
+  ESP_LOGCONFIG(TAG, "Energy:");
+  ESP_LOGCONFIG(TAG, "  %-22s %.3f kWh", "total", EnergyMeter::to_kwh(this->energy_.total()));
+  ESP_LOGCONFIG(TAG, "  %-22s %.3f kWh", "current hour", EnergyMeter::to_kwh(this->energy_.hour()));
+  ESP_LOGCONFIG(TAG, "  %-22s %.3f kWh", "current day", EnergyMeter::to_kwh(this->energy_.day()));
+  dump_buckets("last hours (Wh)", ENERGY_HOURS, false);
+  dump_buckets("last days (Wh)", ENERGY_DAYS, true);
+  ESP_LOGCONFIG(TAG, "  %-22s %u (longer than %u ms)", "gaps not counted", (unsigned) this->energy_.gaps(),
+                (unsigned) this->energy_.get_gap_max());
+  ESP_LOGCONFIG(TAG, "  %-22s %u", "flash writes", (unsigned) this->energy_writes_);
 }
 
 /*
  * Packet handling
  */
 
+/*
+ * Packet framing
+ */
+
+bool PanasonicACCNT::is_packet_header(uint8_t byte) { return byte == CTRL_HEADER || byte == POLL_HEADER; }
+
+size_t PanasonicACCNT::packet_length() {
+  if (this->rx_buffer_.size() < 2)
+    return 0;
+
+  return this->rx_buffer_[1] + 3;  // Payload plus header, packet length and checksum
+}
+
 bool PanasonicACCNT::verify_packet() {
   if (this->rx_buffer_.size() < 12) {
     ESP_LOGW(TAG, "Dropping invalid packet (length)");
+    this->link_error(LINK_DROPS_LENGTH);
 
     this->rx_buffer_.clear();  // Reset buffer
     return false;
@@ -314,6 +629,7 @@ bool PanasonicACCNT::verify_packet() {
   // Check if header matches
   if (this->rx_buffer_[0] != CTRL_HEADER && this->rx_buffer_[0] != POLL_HEADER) {
     ESP_LOGW(TAG, "Dropping invalid packet (header)");
+    this->link_error(LINK_DROPS_HEADER);
 
     this->rx_buffer_.clear();  // Reset buffer
     return false;
@@ -322,6 +638,7 @@ bool PanasonicACCNT::verify_packet() {
   // Packet length minus header, packet length and checksum
   if (this->rx_buffer_[1] != this->rx_buffer_.size() - 3) {
     ESP_LOGD(TAG, "Dropping invalid packet (length mismatch)");
+    this->link_error(LINK_DROPS_LENGTH_MISMATCH);
 
     this->rx_buffer_.clear();  // Reset buffer
     return false;
@@ -335,6 +652,7 @@ bool PanasonicACCNT::verify_packet() {
 
   if (checksum != 0) {
     ESP_LOGD(TAG, "Dropping invalid packet (checksum)");
+    this->link_error(LINK_DROPS_CHECKSUM);
 
     this->rx_buffer_.clear();  // Reset buffer
     return false;
@@ -345,59 +663,66 @@ bool PanasonicACCNT::verify_packet() {
 
 void PanasonicACCNT::handle_packet() {
   if (this->rx_buffer_[0] == POLL_HEADER) {
-    // Always extract the polled data into a temporary vector first
-    std::vector<uint8_t> temp_polled_data = std::vector<uint8_t>(this->rx_buffer_.begin() + 2, this->rx_buffer_.begin() + 12);
-
-    // Store original data to restore after checks (if needed)
-    std::vector<uint8_t> original_data = this->data; 
-    this->data = temp_polled_data; // Temporarily make polled data active for determine_preset/eco
-
-    bool should_publish_poll_state = true; // Flag to decide if we publish the polled state
-
-    if (this->suppress_poll_update_for_eco_preset_) {
-        // Check for timeout
-        if (millis() > this->suppress_poll_timeout_) {
-            ESP_LOGW(TAG, "Optimistic Eco/Preset suppression timed out. Publishing polled state.");
-            this->suppress_poll_update_for_eco_preset_ = false; // Reset flag
-        } else {
-            // Determine the polled Eco and Preset states using the temporary data
-            bool current_polled_eco_state = determine_eco(this->data[8]); // Uses temp_polled_data[8]
-            climate::ClimatePreset current_polled_preset = determine_preset(this->data[5]); // Uses temp_polled_data[5] and temp_polled_data[8]
-
-            if ((this->eco_state_ == current_polled_eco_state) && (this->preset == current_polled_preset)) {
-                // Polled state matches optimistic state, so clear the flag and proceed
-                this->suppress_poll_update_for_eco_preset_ = false;
-                ESP_LOGD(TAG, "Poll confirmed optimistic Eco/Preset state, proceeding with update.");
-            } else {
-                // Polled state does not match optimistic state, suppress this update
-                should_publish_poll_state = false;
-                ESP_LOGD(TAG, "Suppressing poll update for Eco/Preset - polled state does not match optimistic.");
-            }
-        }
+    // Some units answer with fewer bytes, their state is used but temperatures and power consumption are not
+    StateBlock state;
+    PollResponse poll;
+
+    if (!StateBlock::wrap(this->rx_buffer_.data() + 2, this->rx_buffer_.size() - 2, &state)) {
+      ESP_LOGW(TAG, "Dropping invalid poll response (length)");
+      return;
     }
-    
-    this->data = original_data; // Restore original data (important!)
-
-    if (should_publish_poll_state) {
-        this->data = temp_polled_data; // Assign the polled data to the actual data member for the real update
-        this->set_data(true);
-        this->publish_state();
-        if (this->state_ != ACState::Ready)
-            this->state_ = ACState::Ready;
+    bool complete = PollResponse::wrap(this->rx_buffer_.data(), this->rx_buffer_.size(), &poll);
+
+    // CN-CNT doesn't answer control frames, the first poll answered after one stands in for the answer
+    this->command_acknowledged();
+
+    // Unchanged poll responses count as well, energy is integrated over the time between any two of them
+    if (complete && this->has_energy_sensors() && poll.power() >= poll.power_offset())
+      this->energy_.add(millis(), determine_power_consumption(poll.power(), poll.power_offset()));
+
+    if (is_unchanged_poll()) {
+      set_poll_interval_changed(false);
+      this->frames_unchanged_++;
+      return;
+    }
+
+    this->polled_data_.assign(state.data(), StateBlock::SIZE);
+
+    if (this->intents_.any_pending())
+      reconcile_intents();  // Keep requested values the AC has not applied yet
+
+    if (!this->intents_.any_pending())
+      this->command_settled();
+
+    if (complete)
+      update_poll_interval(poll);
+    else
+      set_poll_interval_changed(this->polled_data_ != this->data);
+
+    if (this->state_ == ACState::Cached) {
+      if (this->polled_data_ != this->data)
+        ESP_LOGD(TAG, "AC state changed since it was cached");
+      if (this->cmd_pending_)
+        rebase_cmd();
     }
+
+    this->data = this->polled_data_;
+    this->last_poll_valid_ = this->last_poll_.assign(this->rx_buffer_.data(), this->rx_buffer_.size());
+    // Edits made against the cached state stay on show until their command is sent
+    this->set_data(true, this->state_ == ACState::Cached && this->cmd_pending_ ? this->cmd : this->data);
+    this->schedule_publish();
+    if (this->state_ != ACState::Ready)
+      this->state_ = ACState::Ready;
   } else {
     ESP_LOGD(TAG, "Received unknown packet");
   }
 }
 
-climate::ClimateMode PanasonicACCNT::determine_mode(uint8_t mode) {
-  uint8_t nib1 = (mode >> 4) & 0x0F;  // Left nib for mode
-  uint8_t nib2 = (mode >> 0) & 0x0F;  // Right nib for power state
-
-  if (nib2 == 0x00)
+climate::ClimateMode PanasonicACCNT::determine_mode(uint8_t mode, uint8_t power) {
+  if (power == 0x00)
     return climate::CLIMATE_MODE_OFF;
 
-  switch (nib1) {
+  switch (mode) {
     case 0x00:  // Auto
       return climate::CLIMATE_MODE_HEAT_COOL;
     case 0x03:  // Cool
@@ -414,15 +739,15 @@ climate::ClimateMode PanasonicACCNT::determine_mode(uint8_t mode) {
   }
 }
 
-climate::ClimateFanMode PanasonicACCNT::determine_fan_mode(uint8_t fan_mode_byte) {
-  // Check if the "Quiet" bit (0x04) is set in data[5].
-  // This bit determines if Quiet mode is active, regardless of the fan_mode_byte.
-  if ((this->data[5] & 0x04) == 0x04) {
+climate::ClimateFanMode PanasonicACCNT::determine_fan_mode(uint8_t fan_speed, uint8_t preset) {
+  // Check if the "Quiet" bit (0x04) is set in the preset.
+  // This bit determines if Quiet mode is active, regardless of the fan speed.
+  if ((preset & 0x04) == 0x04) {
     return climate::CLIMATE_FAN_QUIET;
   }
 
-  // If Quiet bit is not set, then determine based on the actual fan mode byte.
-  switch (fan_mode_byte) {
+  // If Quiet bit is not set, then determine based on the actual fan speed.
+  switch (fan_speed) {
     case 0xA0:
       return climate::CLIMATE_FAN_AUTO;
     case 0x30:
@@ -441,65 +766,37 @@ climate::ClimateFanMode PanasonicACCNT::determine_fan_mode(uint8_t fan_mode_byte
   }
 }
 
-std::string PanasonicACCNT::determine_vertical_swing(uint8_t swing) {
-  uint8_t nib = (swing >> 4) & 0x0F;  // Left nib for vertical swing
-
-  switch (nib) {
-    case 0x0E:
-      return "Swing";
-    case 0x0F:
-      return "Auto";
-    case 0x01:
-      return "Top";
-    case 0x02:
-      return "Middle Top";
-    case 0x03:
-      return "Middle";
-    case 0x04:
-      return "Middle Bottom";
-    case 0x05:
-      return "Bottom";
-    case 0x00:
-      return "unsupported";
-    default:
-      ESP_LOGW(TAG, "Received unknown vertical swing mode: 0x%02X", nib);
-      return "Unknown";
-  }
-}
-
-std::string PanasonicACCNT::determine_horizontal_swing(uint8_t swing) {
-  uint8_t nib = (swing >> 0) & 0x0F;  // Right nib for horizontal swing
-
-  switch (nib) {
-    case 0x0D:
-      return "Swing";
-    case 0x09:
-      return "Left";
-    case 0x0A:
-      return "Center Left";
-    case 0x06:
-      return "Center";
-    case 0x0B:
-      return "Center Right";
-    case 0x0C:
-      return "Right";
-    case 0x00:
-      return "unsupported";
-    default:
-      ESP_LOGW(TAG, "Received unknown horizontal swing mode");
-      return "Unknown";
+VerticalSwing PanasonicACCNT::determine_vertical_swing(uint8_t swing) {
+  VerticalSwing position;
+
+  if (!VERTICAL_SWING.decode(swing, &position)) {
+    ESP_LOGW(TAG, "Received unknown vertical swing mode: 0x%02X", swing);
+    return VerticalSwing::Unknown;
+  }
+
+  return position;
+}
+
+HorizontalSwing PanasonicACCNT::determine_horizontal_swing(uint8_t swing) {
+  HorizontalSwing position;
+
+  if (!HORIZONTAL_SWING.decode(swing, &position)) {
+    ESP_LOGW(TAG, "Received unknown horizontal swing mode");
+    return HorizontalSwing::Unknown;
   }
+
+  return position;
 }
 
-climate::ClimatePreset PanasonicACCNT::determine_preset(uint8_t preset_byte) {
-  // First, check if eco mode is active via data[8]
-  if ((this->data[8] & 0x40) == 0x40) {
+climate::ClimatePreset PanasonicACCNT::determine_preset(uint8_t preset, uint8_t eco) {
+  // First, check if eco mode is active
+  if ((eco & 0x40) == 0x40) {
     return climate::CLIMATE_PRESET_ECO;
   }
 
-  // Then check for Boost preset (0x02 in preset_byte).
+  // Then check for Boost preset (0x02 in preset).
   // Quiet (0x04) is now handled by determine_fan_mode, so it should not be here.
-  if ((preset_byte & 0x02) == 0x02) { 
+  if ((preset & 0x02) == 0x02) { 
       return climate::CLIMATE_PRESET_BOOST;
   }
   
@@ -507,19 +804,6 @@ climate::ClimatePreset PanasonicACCNT::determine_preset(uint8_t preset_byte) {
   return climate::CLIMATE_PRESET_NONE;
 }
 
-bool PanasonicACCNT::determine_preset_nanoex(uint8_t preset) {
-  uint8_t nib = (preset >> 4) & 0x04;  // Left nib for nanoex
-
-  if (nib == 0x04)
-    return true;
-  else if (nib == 0x00)
-    return false;
-  else {
-    ESP_LOGW(TAG, "Received unknown nanoex value");
-    return false;
-  }
-}
-
 bool PanasonicACCNT::determine_eco(uint8_t value) {
   if (value == 0x40)
     return true;
@@ -531,19 +815,6 @@ bool PanasonicACCNT::determine_eco(uint8_t value) {
   }
 }
 
-bool PanasonicACCNT::determine_econavi(uint8_t value) {
-  uint8_t nib = value & 0x10;
-  
-  if (nib == 0x10)
-    return true;
-  else if (nib == 0x00)
-    return false;
-  else {
-    ESP_LOGW(TAG, "Received unknown econavi value");
-    return false;
-  }
-}
-
 bool PanasonicACCNT::determine_mild_dry(uint8_t value) {
   if (value == 0x7F)
     return true;
@@ -555,171 +826,89 @@ bool PanasonicACCNT::determine_mild_dry(uint8_t value) {
   }
 }
 
-uint16_t PanasonicACCNT::determine_power_consumption(uint8_t byte_28, uint8_t byte_29, uint8_t offset) {
-  return (uint16_t)(byte_28 + (byte_29 * 256)) - offset;
-}
+uint16_t PanasonicACCNT::determine_power_consumption(uint16_t power, uint8_t offset) { return power - offset; }
 
 /*
  * Sensor handling
  */
 
 void PanasonicACCNT::on_vertical_swing_change(const std::string &swing) {
-  if (this->state_ != ACState::Ready)
+  if (this->state_ == ACState::Initializing)
     return;
 
-  ESP_LOGD(TAG, "Setting vertical swing position");
-
-  if (this->cmd.empty()) {
-    ESP_LOGV(TAG, "Copying data to cmd");
-    this->cmd = this->data;
-  }
+  VerticalSwing position;
 
-  if (swing == "Bottom")
-    this->cmd[4] = (this->cmd[4] & 0x0F) + 0x50;
-  else if (swing == "Middle Bottom")
-    this->cmd[4] = (this->cmd[4] & 0x0F) + 0x40;
-  else if (swing == "Middle")
-    this->cmd[4] = (this->cmd[4] & 0x0F) + 0x30;
-  else if (swing == "Middle Top")
-    this->cmd[4] = (this->cmd[4] & 0x0F) + 0x20;
-  else if (swing == "Top")
-    this->cmd[4] = (this->cmd[4] & 0x0F) + 0x10;
-  else if (swing == "Swing")
-    this->cmd[4] = (this->cmd[4] & 0x0F) + 0xE0;
-  else if (swing == "Auto")
-    this->cmd[4] = (this->cmd[4] & 0x0F) + 0xF0;
-  else {
+  if (!VERTICAL_SWING.parse(swing, &position) || position == VerticalSwing::Unsupported) {
     ESP_LOGW(TAG, "Unsupported vertical swing position received");
     return;
   }
 
+  ESP_LOGD(TAG, "Setting vertical swing position");
+
+  edit_cmd().set_vertical_swing(VERTICAL_SWING.encode(position));
 }
 
 void PanasonicACCNT::on_horizontal_swing_change(const std::string &swing) {
-  if (this->state_ != ACState::Ready)
+  if (this->state_ == ACState::Initializing)
     return;
 
-  ESP_LOGD(TAG, "Setting horizontal swing position");
-
-  if (this->cmd.empty()) {
-    ESP_LOGV(TAG, "Copying data to cmd");
-    this->cmd = this->data;
-  }
+  HorizontalSwing position;
 
-  if (swing == "Left")
-    this->cmd[4] = (this->cmd[4] & 0xF0) + 0x09;
-  else if (swing == "Center Left")
-    this->cmd[4] = (this->cmd[4] & 0xF0) + 0x0A;
-  else if (swing == "Center")
-    this->cmd[4] = (this->cmd[4] & 0xF0) + 0x06;
-  else if (swing == "Center Right")
-    this->cmd[4] = (this->cmd[4] & 0xF0) + 0x0B;
-  else if (swing == "Right")
-    this->cmd[4] = (this->cmd[4] & 0xF0) + 0x0C;
-  else if (swing == "Swing")
-    this->cmd[4] = (this->cmd[4] & 0xF0) + 0x0D;
-  else {
+  if (!HORIZONTAL_SWING.parse(swing, &position) || position == HorizontalSwing::Unsupported) {
     ESP_LOGW(TAG, "Unsupported horizontal swing position received");
     return;
   }
 
+  ESP_LOGD(TAG, "Setting horizontal swing position");
+
+  edit_cmd().set_horizontal_swing(HORIZONTAL_SWING.encode(position));
 }
 
 void PanasonicACCNT::on_nanoex_change(bool state) {
-  if (this->state_ != ACState::Ready)
+  if (this->state_ == ACState::Initializing)
     return;
 
-  if (this->cmd.empty()) {
-    ESP_LOGV(TAG, "Copying data to cmd: NanoeX switch");
-    this->cmd = this->data;
-  }
-
   this->nanoex_state_ = state;
 
-  if (state) {
-    ESP_LOGV(TAG, "Turning nanoex on");
-    this->cmd[5] = (this->cmd[5] & 0x0F) + 0x40;
-  } else {
-    ESP_LOGV(TAG, "Turning nanoex off");
-    this->cmd[5] = (this->cmd[5] & 0x0F);
-  }
+  ESP_LOGV(TAG, "Turning nanoex %s", state ? "on" : "off");
+  edit_cmd().set_nanoex(state);
 }
 
 void PanasonicACCNT::on_eco_change(bool state) {
-  if (this->state_ != ACState::Ready)
+  if (this->state_ == ACState::Initializing)
     return;
 
-  if (this->cmd.empty()) {
-    ESP_LOGV(TAG, "Copying data to cmd: Eco switch");
-    this->cmd = this->data;
-  }
+  StateBlockWriter cmd = edit_cmd();
 
-  this->eco_state_ = state; // Optimistically set the state of the Eco switch
-  // Also update climate preset optimistically if Eco switch is linked to it
-  if (state) {
-      this->preset = climate::CLIMATE_PRESET_ECO;
-  } else {
-      this->preset = climate::CLIMATE_PRESET_NONE;
-  }
-  
-  this->publish_state(); // Publish the climate component's optimistic state
+  this->eco_state_ = state;
 
   if (state) {
     ESP_LOGV(TAG, "Turning eco mode on");
-    this->cmd[8] = 0x40;  // Set the byte corresponding to eco mode
+    cmd.set_eco(0x40);
   } else {
     ESP_LOGV(TAG, "Turning eco mode off");
-    this->cmd[8] = 0x00;  // Clear the byte corresponding to eco mode
+    cmd.set_eco(0x00);
   }
-
-  // Activate suppression for next poll
-  this->suppress_poll_update_for_eco_preset_ = true;
-  this->suppress_poll_timeout_ = millis() + SUPPRESSION_DURATION_MS;
-
-  // Send the modified command immediately
-  send_command(this->cmd, CommandType::Normal, CTRL_HEADER);
 }
 
 void PanasonicACCNT::on_econavi_change(bool state) {
-  if (this->state_ != ACState::Ready)
+  if (this->state_ == ACState::Initializing)
     return;
 
-  if (this->cmd.empty()) {
-    ESP_LOGV(TAG, "Copying data to cmd: Econavi switch");
-    this->cmd = this->data;
-  }
-
   this->econavi_state_ = state;
 
-  if (state) {
-    ESP_LOGV(TAG, "Turning econavi mode on");
-    this->cmd[5] = (this->cmd[5] & 0xF0) + 0x10; // Only set the bit, don't clear the entire byte
-  } else {
-    ESP_LOGV(TAG, "Turning econavi mode off");
-    this->cmd[5] = (this->cmd[5] & 0xF0); // Clear the bit, don't clear the entire byte
-  }
-
+  ESP_LOGV(TAG, "Turning econavi mode %s", state ? "on" : "off");
+  edit_cmd().set_econavi(state);
 }
 
 void PanasonicACCNT::on_mild_dry_change(bool state) {
-  if (this->state_ != ACState::Ready)
+  if (this->state_ == ACState::Initializing)
     return;
 
-  if (this->cmd.empty()) {
-    ESP_LOGV(TAG, "Copying data to cmd: Mild dry switch");
-    this->cmd = this->data;
-  }
-
   this->mild_dry_state_ = state;
 
-  if (state) {
-    ESP_LOGV(TAG, "Turning mild dry on");
-    this->cmd[2] = 0x7F;
-  } else {
-    ESP_LOGV(TAG, "Turning mild dry off");
-    this->cmd[2] = 0x80;
-  }
-
+  ESP_LOGV(TAG, "Turning mild dry %s", state ? "on" : "off");
+  edit_cmd().set_mild_dry(state ? 0x7F : 0x80);
 }
 
 }  // namespace CNT
@@ -1,6 +1,10 @@
 #include "esphome/components/climate/climate.h"
 #include "esphome/components/climate/climate_mode.h"
+#include "esphome/core/preferences.h"
 #include "esppac.h"
+#include "esppac_energy.h"
+#include "esppac_intent.h"
+#include "esppac_schema.h"
 
 namespace esphome {
 namespace panasonic_ac {
@@ -9,11 +13,22 @@ namespace CNT {
 static const uint8_t CTRL_HEADER = 0xF0;  // The header for control frames
 static const uint8_t POLL_HEADER = 0x70;  // The header for the poll command
 
-static const int POLL_INTERVAL = 5000;  // The interval at which to poll the AC
-static const int CMD_INTERVAL = 250;  // The interval at which to send commands
+static const int POLL_INTERVAL_MIN = 2000;   // The default interval at which to poll the AC while its state changes
+static const int POLL_INTERVAL_MAX = 60000;  // The default interval the poll rate backs off to while nothing changes
+static const int CONFIRM_POLL_DELAY = 500;   // The delay after a command before polling for its result
+static const uint16_t POLL_POWER_DELTA = 25;  // Change in power consumption (W) that counts as a state change
+static const int CMD_INTERVAL = 250;  // The minimum gap between the last frame and a command
+static const int CMD_COALESCE_TIME = 50;  // Time to wait for further edits before sending a command
+static const int CMD_CONFIRM_TIMEOUT = 6000;  // Time after which polls replace a requested value they do not confirm
+static const int8_t TEMPERATURE_UNSUPPORTED = -128;  // Temperature bytes read 0x80 if the unit has no such sensor
+static const size_t COMMAND_MAX_LENGTH = StateBlock::SIZE;  // Payload length of polls and control frames
+static const uint32_t CACHE_WRITE_INTERVAL = 600000;  // Minimum time between two writes of the state cache to flash
+static const uint32_t ENERGY_WRITE_INTERVAL = 3600000;  // Minimum time between two writes of the energy totals to flash
+static const uint32_t ENERGY_PUBLISH_INTERVAL = 300000;  // Minimum time between two publishes of the energy sensors
 
 enum class ACState {
   Initializing,  // Before first query response is receive
+  Cached,        // Showing the state cached before the restart, commands wait for the first query response
   Ready,         // All done, ready to receive regular packets
 };
 
@@ -30,41 +45,101 @@ class PanasonicACCNT : public PanasonicAC {
 
   void setup() override;
   void loop() override;
+  void on_safe_shutdown() override;
+  void dump_config() override;
+
+  void set_poll_interval(uint32_t min, uint32_t max);
+  void set_energy_total_sensor(sensor::Sensor *sensor) { this->energy_total_sensor_ = sensor; }
+  void set_energy_hour_sensor(sensor::Sensor *sensor) { this->energy_hour_sensor_ = sensor; }
+  void set_energy_day_sensor(sensor::Sensor *sensor) { this->energy_day_sensor_ = sensor; }
+
+  void dump_energy();
+
+  uint32_t get_poll_interval() const { return this->poll_interval_; }
+  uint32_t get_frames_sent() const { return this->link_.total(LINK_FRAMES_OUT); }
+  uint32_t get_commands_merged() const { return this->commands_merged_; }
+  uint32_t get_commands_suppressed() const { return this->commands_suppressed_; }
+  uint32_t get_intents_confirmed() const { return this->intents_.get_confirmed(); }
+  uint32_t get_intents_timed_out() const { return this->intents_.get_timed_out(); }
+  uint32_t get_cache_writes() const { return this->cache_writes_; }
+  uint32_t get_energy_writes() const { return this->energy_writes_; }
+  const EnergyMeter &get_energy() const { return this->energy_; }
 
  protected:
   ACState state_ = ACState::Initializing;  // Stores the internal state of the AC, used during initialization
 
-  // uint8_t data[10];
-  std::vector<uint8_t> data = std::vector<uint8_t>(10);  // Stores the data received from the AC
-  std::vector<uint8_t> cmd;  // Used to build next command
+  StateBlockData data{};         // Stores the data received from the AC, with the fields of pending intents as requested
+  StateBlockData cmd{};          // Used to build next command
+  bool cmd_pending_ = false;     // Set to true while cmd holds a command that has not been sent yet
+  StateBlockData polled_data_{};  // Stores the data of the poll being handled
+  PollResponseData last_poll_{};  // The last poll response that became the data
+  bool last_poll_valid_ = false;  // Set to false when the data may have changed since last_poll_
+  IntentTable<StateBlock::FIELD_COUNT> intents_{CMD_CONFIRM_TIMEOUT};  // Fields sent to the AC but not polled yet
+  uint32_t cmd_created_ = 0;       // Stores the time of the first edit of the pending command
+
+  ESPPreferenceObject cache_pref_;  // The last state block the AC confirmed, published at boot until the first poll
+  StateBlockData cached_{};         // The state block last written to cache_pref_
+  uint32_t cache_written_ = 0;      // Time of the last write to cache_pref_
+  uint32_t cache_writes_ = 0;       // Number of writes to cache_pref_ since boot
+
+  sensor::Sensor *energy_total_sensor_ = nullptr;  // Energy (kWh) since the meter was first set up
+  sensor::Sensor *energy_hour_sensor_ = nullptr;   // Energy (kWh) of the current hour
+  sensor::Sensor *energy_day_sensor_ = nullptr;    // Energy (kWh) of the current day
+  EnergyMeter energy_;                             // Integrates the power consumption of every poll response
+  ESPPreferenceObject energy_pref_;                // Energy totals and buckets, carried on after a restart
+  EnergyData energy_saved_{};                      // The energy data last written to energy_pref_
+  uint32_t energy_written_ = 0;                    // Time of the last write to energy_pref_
+  uint32_t energy_writes_ = 0;                     // Number of writes to energy_pref_ since boot
+  uint64_t energy_published_ = UINT64_MAX;         // Total energy (Wh) last published
+  uint32_t energy_published_hours_ = 0;            // Hours the meter had closed at the last publish
+  uint32_t energy_publish_time_ = 0;               // Time of the last publish of the energy sensors
+
+  uint32_t poll_interval_min_ = POLL_INTERVAL_MIN;  // Poll interval used while the state changes
+  uint32_t poll_interval_max_ = POLL_INTERVAL_MAX;  // Poll interval the backoff is capped at
+  uint32_t poll_interval_ = POLL_INTERVAL_MIN;      // Current poll interval, doubles for every poll without changes
+  int8_t last_poll_temperatures_[4] = {TEMPERATURE_UNSUPPORTED, TEMPERATURE_UNSUPPORTED, TEMPERATURE_UNSUPPORTED,
+                                       TEMPERATURE_UNSUPPORTED};  // Temperatures of the last poll response
+  uint16_t last_poll_power_ = 0;                    // Power consumption of the last poll response
+
+  uint32_t commands_merged_ = 0;      // Number of edits merged into an already pending command
+  uint32_t commands_suppressed_ = 0;  // Number of commands dropped because they would not change anything
 
   void handle_poll();
+  void update_poll_interval(const PollResponse &poll);
+  void set_poll_interval_changed(bool changed);
+  bool is_unchanged_poll();
   void handle_cmd();
+  StateBlockWriter edit_cmd();
+  void reconcile_intents();
+  void rebase_cmd();
+  void handle_cache(bool force);
+  bool has_energy_sensors() const;
+  void handle_energy(bool force);
+  void publish_energy();
 
-  void set_data(bool set);
+  void set_data(bool set) { this->set_data(set, this->data); }
+  void set_data(bool set, const StateBlockData &block);
 
-  void send_command(std::vector<uint8_t> command, CommandType type, uint8_t header);
-  void send_packet(const std::vector<uint8_t> &command, CommandType type);
+  bool send_command(const uint8_t *command, size_t length, CommandType type, uint8_t header);
+  bool send_packet(const uint8_t *packet, size_t length, CommandType type);
+  void prepare_frame(uint8_t *data, size_t length, CommandType type) override;
+
+  bool is_packet_header(uint8_t byte) override;
+  size_t packet_length() override;
 
   bool verify_packet();
   void handle_packet();
 
-  climate::ClimateMode determine_mode(uint8_t mode);
-  climate::ClimateFanMode determine_fan_mode(uint8_t fan_mode);
+  climate::ClimateMode determine_mode(uint8_t mode, uint8_t power);
+  climate::ClimateFanMode determine_fan_mode(uint8_t fan_speed, uint8_t preset);
 
-  std::string determine_vertical_swing(uint8_t swing);
-  std::string determine_horizontal_swing(uint8_t swing);
+  VerticalSwing determine_vertical_swing(uint8_t swing);
+  HorizontalSwing determine_horizontal_swing(uint8_t swing);
 
-  climate::ClimatePreset determine_preset(uint8_t preset);
-  bool determine_preset_nanoex(uint8_t preset);
+  climate::ClimatePreset determine_preset(uint8_t preset, uint8_t eco);
   bool determine_eco(uint8_t value);
-  bool determine_econavi(uint8_t value);
   bool determine_mild_dry(uint8_t value);
-  uint16_t determine_power_consumption(uint8_t byte_28, uint8_t multiplier, uint8_t offset);
-
-  bool suppress_poll_update_for_eco_preset_ = false;
-  unsigned long suppress_poll_timeout_ = 0;
-  const unsigned long SUPPRESSION_DURATION_MS = 5000; // 5 seconds timeout for optimistic state
+  uint16_t determine_power_consumption(uint16_t power, uint8_t offset);
 };
 
 }  // namespace CNT
@@ -1,4 +1,4 @@
-#include <vector>
+#include <cstdint>
 
 namespace esphome {
 namespace panasonic_ac {
@@ -8,7 +8,7 @@ namespace CNT {
  * Poll command
  */
 
-static const std::vector<uint8_t> CMD_POLL = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const uint8_t CMD_POLL[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
 /*
  * Control command
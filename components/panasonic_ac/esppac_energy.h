@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace panasonic_ac {
+
+static const uint32_t ENERGY_HOUR = 3600000;       // Length (ms) of an hourly bucket
+static const size_t ENERGY_HOURS = 24;             // Hourly buckets kept, a daily bucket closes with every 24th
+static const size_t ENERGY_DAYS = 7;               // Daily buckets kept
+static const uint64_t ENERGY_MJ_PER_WH = 3600000;  // Energy is counted in mJ (W * ms)
+
+/*
+ * Everything the energy meter needs to carry on after a restart, kept in flash as it is
+ */
+struct EnergyData {
+  uint64_t total;                // Energy since the meter was first set up, in mJ
+  uint64_t hour_start;           // total at the start of the current hour
+  uint64_t day_start;            // total at the start of the current day
+  uint32_t hour_elapsed;         // Time (ms) counted into the current hour
+  uint32_t hours[ENERGY_HOURS];  // Energy of the last complete hours in Wh, the oldest at hour_index
+  uint32_t days[ENERGY_DAYS];    // Energy of the last complete days in Wh, the oldest at day_index
+  uint8_t hour_index;            // Next hourly bucket to be written
+  uint8_t day_index;             // Next daily bucket to be written
+  uint8_t hours_in_day;          // Complete hours in the current day
+};
+
+/*
+ * Integrates power samples into energy, with the total and the last hours and days in buckets
+ *
+ * The energy between two samples is their mean times the time between them, so it stays right whatever the poll rate.
+ * Gaps longer than the gap limit (a restart, a dead link) are not counted rather than guessed. Hours and days are
+ * counted in the time the meter runs, an interval crossing into the next hour is split between both buckets.
+ */
+class EnergyMeter {
+ public:
+  static constexpr uint32_t GAP_MAX_DEFAULT = 600000;  // Longest time (ms) between two samples that is integrated
+
+  // Sets the gap limit, it has to stay above the longest time between two samples while the link is fine
+  void set_gap_max(uint32_t gap_max) { this->gap_max_ = gap_max; }
+  uint32_t get_gap_max() const { return this->gap_max_; }
+
+  void add(uint32_t now, uint16_t watts) {
+    if (this->has_sample_) {
+      uint32_t elapsed = now - this->last_time_;
+
+      if (elapsed > this->gap_max_)
+        this->gaps_++;
+      else if (elapsed > 0)
+        this->advance((uint64_t(this->last_watts_) + watts) * elapsed / 2, elapsed);
+    }
+
+    this->last_time_ = now;
+    this->last_watts_ = watts;
+    this->has_sample_ = true;
+  }
+
+  // Carries on from stored data, the first sample after it starts a new interval
+  void restore(const EnergyData &data) {
+    this->data_ = data;
+    this->data_.hour_index %= ENERGY_HOURS;
+    this->data_.day_index %= ENERGY_DAYS;
+    this->data_.hours_in_day %= ENERGY_HOURS;
+    if (this->data_.hour_elapsed >= ENERGY_HOUR)
+      this->data_.hour_elapsed = 0;
+    this->has_sample_ = false;
+  }
+
+  const EnergyData &data() const { return this->data_; }
+
+  uint64_t total() const { return this->data_.total; }
+  uint64_t hour() const { return this->data_.total - this->data_.hour_start; }  // Energy of the current hour
+  uint64_t day() const { return this->data_.total - this->data_.day_start; }    // Energy of the current day
+
+  // Energy (Wh) of a complete hour or day, 0 is the last one
+  uint32_t last_hour(size_t age) const {
+    return this->data_.hours[(this->data_.hour_index + ENERGY_HOURS - 1 - age % ENERGY_HOURS) % ENERGY_HOURS];
+  }
+  uint32_t last_day(size_t age) const {
+    return this->data_.days[(this->data_.day_index + ENERGY_DAYS - 1 - age % ENERGY_DAYS) % ENERGY_DAYS];
+  }
+
+  uint32_t hours_closed() const { return this->hours_closed_; }  // Hours completed since boot
+  uint32_t gaps() const { return this->gaps_; }                  // Intervals left out for being longer than the limit
+
+  static float to_kwh(uint64_t mj) { return mj / (ENERGY_MJ_PER_WH * 1000.0); }
+
+ protected:
+  void advance(uint64_t energy, uint32_t elapsed) {
+    while (this->data_.hour_elapsed + elapsed >= ENERGY_HOUR) {
+      uint32_t part = ENERGY_HOUR - this->data_.hour_elapsed;
+      uint64_t share = energy * part / elapsed;
+
+      this->data_.total += share;
+      energy -= share;
+      elapsed -= part;
+      this->close_hour();
+    }
+
+    this->data_.total += energy;
+    this->data_.hour_elapsed += elapsed;
+  }
+
+  void close_hour() {
+    this->data_.hours[this->data_.hour_index] = this->hour() / ENERGY_MJ_PER_WH;
+    this->data_.hour_index = (this->data_.hour_index + 1) % ENERGY_HOURS;
+    this->data_.hour_start = this->data_.total;
+    this->data_.hour_elapsed = 0;
+    this->hours_closed_++;
+
+    if (++this->data_.hours_in_day < ENERGY_HOURS)
+      return;
+
+    this->data_.days[this->data_.day_index] = this->day() / ENERGY_MJ_PER_WH;
+    this->data_.day_index = (this->data_.day_index + 1) % ENERGY_DAYS;
+    this->data_.day_start = this->data_.total;
+    this->data_.hours_in_day = 0;
+  }
+
+  EnergyData data_{};
+  uint32_t gap_max_ = GAP_MAX_DEFAULT;
+  uint32_t last_time_ = 0;
+  uint16_t last_watts_ = 0;
+  bool has_sample_ = false;
+  uint32_t hours_closed_ = 0;
+  uint32_t gaps_ = 0;
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
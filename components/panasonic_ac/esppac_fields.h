@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace esphome {
+namespace panasonic_ac {
+
+static const char *const UNKNOWN_LABEL = "Unknown";  // Label of values that are not in a field table
+
+/*
+ * Two-way lookup between the wire value of a field, its enum and its option label
+ *
+ * Entries are indexed by the enum, which has to list the values in the same order. An enum value past the last entry
+ * stands for a wire value that is not in the table.
+ */
+template<typename E, size_t N> struct FieldTable {
+  struct Entry {
+    uint8_t wire;       // The value as sent and received by the AC
+    const char *label;  // The option as shown by the select entity or preset
+  };
+
+  Entry entries[N];
+
+  constexpr uint8_t encode(E value) const { return this->entries[static_cast<size_t>(value)].wire; }
+
+  constexpr const char *label(E value) const {
+    return static_cast<size_t>(value) < N ? this->entries[static_cast<size_t>(value)].label : UNKNOWN_LABEL;
+  }
+
+  // Returns false if the wire value is not in the table
+  constexpr bool decode(uint8_t wire, E *value) const {
+    for (size_t i = 0; i < N; i++) {
+      if (this->entries[i].wire == wire) {
+        *value = static_cast<E>(i);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Returns false if the label is not in the table
+  bool parse(const std::string &label, E *value) const {
+    for (size_t i = 0; i < N; i++) {
+      if (label == this->entries[i].label) {
+        *value = static_cast<E>(i);
+        return true;
+      }
+    }
+
+    return false;
+  }
+};
+
+// Byte and mask of a single byte field, for code that handles the fields of a frame generically
+struct FieldMask {
+  size_t offset;
+  uint8_t mask;
+};
+
+/*
+ * Copy of a frame of N bytes
+ *
+ * Trivially copyable, so it can be kept, copied and compared without allocating. The generated frame classes create
+ * views of it with view() and edit().
+ */
+template<size_t N> struct FrameData {
+  uint8_t bytes[N];
+
+  static constexpr size_t size() { return N; }
+
+  bool operator==(const FrameData &other) const { return std::memcmp(this->bytes, other.bytes, N) == 0; }
+  bool operator!=(const FrameData &other) const { return !(*this == other); }
+
+  // Whether the buffer holds exactly this frame
+  bool equals(const uint8_t *data, size_t length) const {
+    return length == N && std::memcmp(this->bytes, data, N) == 0;
+  }
+
+  // Bits of a field as they are in the frame, without shifting them
+  uint8_t get(FieldMask field) const { return this->bytes[field.offset] & field.mask; }
+  void set(FieldMask field, uint8_t bits) {
+    this->bytes[field.offset] = (this->bytes[field.offset] & ~field.mask) | (bits & field.mask);
+  }
+
+  // Copies the first N bytes of data, returns false if the buffer is too short
+  bool assign(const uint8_t *data, size_t length) {
+    if (length < N)
+      return false;
+
+    std::memcpy(this->bytes, data, N);
+    return true;
+  }
+};
+
+/*
+ * Read-only view of a frame of at least N bytes
+ *
+ * Views are only created over buffers holding the whole frame and field offsets are checked against N at compile time,
+ * so a field can never be read past the end of the buffer. A default constructed view reads zeros.
+ */
+template<size_t N> class FrameReader {
+ public:
+  static constexpr size_t SIZE = N;
+
+  constexpr FrameReader() : data_(ZEROS), length_(N) {}
+
+  const uint8_t *data() const { return this->data_; }
+  size_t length() const { return this->length_; }
+
+ protected:
+  constexpr FrameReader(const uint8_t *data, size_t length) : data_(data), length_(length) {}
+
+  static constexpr uint8_t shift(uint8_t mask) { return (mask & 0x01) ? 0 : 1 + shift(mask >> 1); }
+
+  template<size_t Offset, uint8_t Mask = 0xFF> constexpr uint8_t get_u8() const {
+    static_assert(Offset < N, "Field lies outside of its frame");
+    return (this->data_[Offset] & Mask) >> shift(Mask);
+  }
+
+  template<size_t Offset> constexpr int8_t get_i8() const { return (int8_t) this->get_u8<Offset>(); }
+
+  template<size_t Offset, uint8_t Mask> constexpr bool get_flag() const {
+    static_assert(Offset < N, "Field lies outside of its frame");
+    return (this->data_[Offset] & Mask) == Mask;
+  }
+
+  template<size_t Offset> constexpr uint16_t get_u16le() const {
+    static_assert(Offset + 1 < N, "Field lies outside of its frame");
+    return this->data_[Offset] | (this->data_[Offset + 1] << 8);
+  }
+
+  template<size_t Offset> constexpr uint16_t get_u16be() const {
+    static_assert(Offset + 1 < N, "Field lies outside of its frame");
+    return (this->data_[Offset] << 8) | this->data_[Offset + 1];
+  }
+
+  static constexpr uint8_t ZEROS[N] = {};
+
+  const uint8_t *data_;
+  size_t length_;
+};
+
+/*
+ * Writable view of a frame of at least N bytes, with the same guarantees as FrameReader
+ *
+ * A default constructed view is not bound to a buffer, it reads zeros and drops writes.
+ */
+template<size_t N> class FrameWriter : public FrameReader<N> {
+ public:
+  constexpr FrameWriter() : mutable_data_(nullptr) {}
+
+ protected:
+  constexpr FrameWriter(uint8_t *data, size_t length) : FrameReader<N>(data, length), mutable_data_(data) {}
+
+  template<size_t Offset, uint8_t Mask = 0xFF> void set_u8(uint8_t value) {
+    static_assert(Offset < N, "Field lies outside of its frame");
+    if (this->mutable_data_ == nullptr)
+      return;
+    uint8_t &byte = this->mutable_data_[Offset];
+    byte = (byte & ~Mask) | ((value << FrameReader<N>::shift(Mask)) & Mask);
+  }
+
+  template<size_t Offset> void set_i8(int8_t value) { this->set_u8<Offset>((uint8_t) value); }
+
+  template<size_t Offset, uint8_t Mask> void set_flag(bool value) {
+    static_assert(Offset < N, "Field lies outside of its frame");
+    if (this->mutable_data_ == nullptr)
+      return;
+    uint8_t &byte = this->mutable_data_[Offset];
+    byte = value ? (byte | Mask) : (byte & ~Mask);
+  }
+
+  template<size_t Offset> void set_u16le(uint16_t value) {
+    static_assert(Offset + 1 < N, "Field lies outside of its frame");
+    if (this->mutable_data_ == nullptr)
+      return;
+    this->mutable_data_[Offset] = value & 0xFF;
+    this->mutable_data_[Offset + 1] = value >> 8;
+  }
+
+  template<size_t Offset> void set_u16be(uint16_t value) {
+    static_assert(Offset + 1 < N, "Field lies outside of its frame");
+    if (this->mutable_data_ == nullptr)
+      return;
+    this->mutable_data_[Offset] = value >> 8;
+    this->mutable_data_[Offset + 1] = value & 0xFF;
+  }
+
+  uint8_t *mutable_data_;
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace panasonic_ac {
+
+/*
+ * Values requested from the AC that it has not confirmed yet, one slot per field
+ *
+ * While a request is pending, reported values that contradict it are replaced by the requested value, so the published
+ * state doesn't snap back while the AC is still applying a change. A request ends when the AC reports the requested
+ * value (confirmed) or when the timeout passes without that (timed out), after which the reported value wins again.
+ */
+template<size_t N> class IntentTable {
+  static_assert(N <= 32, "Intent tables track at most 32 fields");
+
+ public:
+  explicit IntentTable(uint32_t timeout) : timeout_(timeout) {}
+
+  // Records the value requested for a field, replacing a pending request for it
+  void request(size_t field, uint8_t value, uint32_t now) {
+    this->intents_[field] = {value, now};
+    this->pending_ |= 1UL << field;
+  }
+
+  // Returns the value to use for a field the AC reported, the requested one while a request contradicts the report
+  uint8_t reconcile(size_t field, uint8_t reported, uint32_t now) {
+    if (!this->is_pending(field))
+      return reported;
+
+    const Intent &intent = this->intents_[field];
+
+    if (reported == intent.value) {
+      this->pending_ &= ~(1UL << field);
+      this->confirmed_++;
+      return reported;
+    }
+
+    if (now - intent.requested > this->timeout_) {
+      this->pending_ &= ~(1UL << field);
+      this->timed_out_++;
+      return reported;
+    }
+
+    this->masked_++;
+    return intent.value;
+  }
+
+  bool is_pending(size_t field) const { return this->pending_ & (1UL << field); }
+  bool any_pending() const { return this->pending_ != 0; }
+
+  uint32_t get_confirmed() const { return this->confirmed_; }
+  uint32_t get_timed_out() const { return this->timed_out_; }
+  uint32_t get_masked() const { return this->masked_; }
+
+ protected:
+  struct Intent {
+    uint8_t value;       // The requested value
+    uint32_t requested;  // Time at which the value was requested
+  };
+
+  Intent intents_[N]{};
+  uint32_t pending_ = 0;  // One bit per field with a pending request
+  uint32_t timeout_;      // Time after which an unconfirmed request is dropped
+
+  uint32_t confirmed_ = 0;  // Number of requests the AC confirmed
+  uint32_t timed_out_ = 0;  // Number of requests dropped because the AC did not confirm them in time
+  uint32_t masked_ = 0;     // Number of reported values replaced because they contradicted a pending request
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
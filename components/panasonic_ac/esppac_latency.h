@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace panasonic_ac {
+
+/*
+ * Constant memory histogram of latencies in ms, with four buckets per power of two
+ *
+ * Percentiles are the upper bound of the bucket they fall in, so they read at most 25% high. Latencies past about two
+ * minutes share the last bucket, the maximum is kept exactly.
+ */
+class LatencyHistogram {
+ public:
+  void add(uint32_t ms) {
+    this->buckets_[bucket_of(ms)]++;
+    this->count_++;
+    if (ms > this->max_)
+      this->max_ = ms;
+  }
+
+  void merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < BUCKETS; i++)
+      this->buckets_[i] += other.buckets_[i];
+    this->count_ += other.count_;
+    if (other.max_ > this->max_)
+      this->max_ = other.max_;
+  }
+
+  uint32_t count() const { return this->count_; }
+  uint32_t max() const { return this->max_; }
+
+  // Upper bound of the bucket holding the given percentile, 0 without samples
+  uint32_t percentile(uint8_t p) const {
+    if (this->count_ == 0)
+      return 0;
+
+    uint32_t target = (uint64_t(this->count_) * p + 99) / 100;
+    uint32_t seen = 0;
+
+    for (size_t i = 0; i < BUCKETS; i++) {
+      seen += this->buckets_[i];
+      if (seen >= target && seen > 0)
+        return upper_bound_of(i) < this->max_ ? upper_bound_of(i) : this->max_;
+    }
+
+    return this->max_;
+  }
+
+ protected:
+  static const size_t BUCKETS = 4 * 16;
+
+  static size_t bucket_of(uint32_t value) {
+    if (value < 4)
+      return value;
+
+    size_t log2 = 31 - __builtin_clz(value);
+    size_t bucket = 4 * (log2 - 1) + ((value >> (log2 - 2)) & 0x03);
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+  }
+
+  static uint32_t upper_bound_of(size_t bucket) {
+    if (bucket < 4)
+      return bucket;
+
+    size_t log2 = bucket / 4 + 1;
+    return (1UL << log2) + ((bucket % 4 + 1) << (log2 - 2)) - 1;
+  }
+
+  uint32_t buckets_[BUCKETS]{};
+  uint32_t count_ = 0;
+  uint32_t max_ = 0;
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
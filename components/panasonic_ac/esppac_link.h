@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace panasonic_ac {
+
+/*
+ * Events on the UART link to the AC
+ */
+enum LinkCounter : uint8_t {
+  LINK_FRAMES_IN,               // Complete frames received, valid or not
+  LINK_BYTES_IN,                // Bytes read from the UART
+  LINK_FRAMES_OUT,              // Frames written, resends included
+  LINK_BYTES_OUT,               // Bytes written
+  LINK_DROPS_LENGTH,            // Frames dropped because they were too short
+  LINK_DROPS_HEADER,            // Frames dropped because of an unknown header
+  LINK_DROPS_LENGTH_MISMATCH,   // Frames dropped because their length byte was wrong
+  LINK_DROPS_CHECKSUM,          // Frames dropped because of a wrong checksum
+  LINK_RESENDS,                 // Frames resent because the AC did not answer in time
+  LINK_COUNTER_CORRECTIONS,     // Packet counters taken over from the AC because they had shifted
+  LINK_OVERFLOWS,               // Bytes lost because a receive buffer was full
+  LINK_RESYNCS,                 // Times the parser had to look for the next header
+  LINK_TX_DROPS,                // Frames not written because the transmit queue was full
+  LINK_COUNTER_COUNT,
+};
+
+// Labels of the link counters, in the order of LinkCounter
+static const char *const LINK_COUNTER_NAMES[LINK_COUNTER_COUNT] = {
+    "frames in",
+    "bytes in",
+    "frames out",
+    "bytes out",
+    "dropped (length)",
+    "dropped (header)",
+    "dropped (length mismatch)",
+    "dropped (checksum)",
+    "resends",
+    "counter corrections",
+    "overflows",
+    "resyncs",
+    "tx drops",
+};
+
+/*
+ * Totals of the link counters and their counts over the last full minute
+ */
+class LinkStats {
+ public:
+  static const uint32_t PERIOD = 60000;  // Length (ms) of the period the rates are counted over
+
+  void count(LinkCounter counter, uint32_t n = 1) { this->totals_[counter] += n; }
+
+  uint32_t total(LinkCounter counter) const { return this->totals_[counter]; }
+  uint32_t last_period(LinkCounter counter) const { return this->last_period_[counter]; }
+
+  // Closes the period once it is over, returns true if it did
+  bool update(uint32_t now) {
+    if (now - this->period_start_ < PERIOD)
+      return false;
+
+    for (size_t i = 0; i < LINK_COUNTER_COUNT; i++) {
+      this->last_period_[i] = this->totals_[i] - this->period_totals_[i];
+      this->period_totals_[i] = this->totals_[i];
+    }
+
+    this->period_start_ = now;
+    return true;
+  }
+
+ protected:
+  uint32_t totals_[LINK_COUNTER_COUNT]{};
+  uint32_t period_totals_[LINK_COUNTER_COUNT]{};  // Totals at the start of the current period
+  uint32_t last_period_[LINK_COUNTER_COUNT]{};    // Counts over the last full period
+  uint32_t period_start_ = 0;
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace panasonic_ac {
+
+static const size_t ENTRY_COUNT_OFFSET = 10;  // Number of entries of reports and query responses
+static const size_t ENTRIES_OFFSET = 11;      // First entry, entries are page, key, value length and value
+static const size_t ENTRY_HEADER_SIZE = 3;    // Page, key and value length
+
+/*
+ * Calls visit(key, value, length) for every entry of a CN-WLAN report or query response, in frame order
+ *
+ * Values can be of any length, so responses of other firmware versions are walked just the same. Every entry is
+ * checked against the end of the frame before it is visited, the last byte is the checksum. Returns false if an
+ * entry is cut off or there are fewer entries than the count announces, the entries before that were visited.
+ */
+template<typename Visitor> bool walk_entries(const uint8_t *frame, size_t length, Visitor &&visit) {
+  if (length <= ENTRIES_OFFSET)
+    return false;
+
+  const size_t end = length - 1;  // Checksum
+  size_t offset = ENTRIES_OFFSET;
+
+  for (size_t i = 0; i < frame[ENTRY_COUNT_OFFSET]; i++) {
+    if (end - offset < ENTRY_HEADER_SIZE || end - offset - ENTRY_HEADER_SIZE < frame[offset + 2])
+      return false;
+
+    visit(frame[offset + 1], frame + offset + ENTRY_HEADER_SIZE, frame[offset + 2]);
+    offset += ENTRY_HEADER_SIZE + frame[offset + 2];
+  }
+
+  return true;
+}
+
+// How raw register sensors read a value
+enum class RawType : uint8_t { U8, I8, U16BE, U16LE };
+
+// Reads a value of the given type from a byte of an entry's value, returns false if it does not fit into the value
+inline bool read_raw(RawType type, const uint8_t *value, size_t length, size_t offset, int32_t *out) {
+  size_t size = type == RawType::U16BE || type == RawType::U16LE ? 2 : 1;
+  if (offset + size > length)
+    return false;
+
+  const uint8_t *data = value + offset;
+
+  switch (type) {
+    case RawType::U8:
+      *out = data[0];
+      break;
+    case RawType::I8:
+      *out = int8_t(data[0]);
+      break;
+    case RawType::U16BE:
+      *out = (data[0] << 8) | data[1];
+      break;
+    case RawType::U16LE:
+      *out = data[0] | (data[1] << 8);
+      break;
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+/*
+ * Last value the AC sent for every key, with the time it arrived and whether it changed since the last clear_changes()
+ *
+ * Unknown keys are kept like any other. Values longer than a byte are kept by their first byte, none of the handled
+ * keys has a longer one.
+ */
+class RegisterFile {
+ public:
+  static const size_t SIZE = 256;
+
+  // Stores a value, returns true if the key had another value or was not seen before
+  bool update(uint8_t key, uint8_t value, uint32_t now) {
+    bool changed = !this->seen(key) || this->values_[key] != value;
+
+    this->values_[key] = value;
+    this->times_[key] = now;
+    this->seen_[key / 32] |= bit(key);
+    if (changed)
+      this->changed_[key / 32] |= bit(key);
+
+    return changed;
+  }
+
+  bool seen(uint8_t key) const { return this->seen_[key / 32] & bit(key); }
+  bool changed(uint8_t key) const { return this->changed_[key / 32] & bit(key); }
+  uint8_t value(uint8_t key) const { return this->values_[key]; }
+  uint32_t time(uint8_t key) const { return this->times_[key]; }  // millis() at which the key last arrived
+
+  // Calls visit(key) for every key that changed, in key order
+  template<typename Visitor> void for_each_changed(Visitor &&visit) const {
+    for (size_t word = 0; word < WORDS; word++) {
+      for (uint32_t bits = this->changed_[word]; bits != 0; bits &= bits - 1)
+        visit(uint8_t(word * 32 + __builtin_ctz(bits)));
+    }
+  }
+
+  void clear_changes() {
+    for (uint32_t &word : this->changed_)
+      word = 0;
+  }
+
+ protected:
+  static const size_t WORDS = SIZE / 32;
+
+  static uint32_t bit(uint8_t key) { return 1UL << (key % 32); }
+
+  uint8_t values_[SIZE]{};
+  uint32_t times_[SIZE]{};
+  uint32_t seen_[WORDS]{};
+  uint32_t changed_[WORDS]{};
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
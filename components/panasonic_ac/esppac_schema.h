@@ -0,0 +1,422 @@
+// Generated by protocol/generate.py from protocol/schema.json, do not edit
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "esppac_fields.h"
+
+namespace esphome {
+namespace panasonic_ac {
+
+namespace CNT {
+
+// CZ-TACG1 protocol via CN-CNT, see cztacg1/protocol_description_query.ods
+
+/*
+ * Field tables, the enums list the values in table order
+ */
+
+enum class VerticalSwing : uint8_t { Swing, Auto, Top, MiddleTop, Middle, MiddleBottom, Bottom, Unsupported, Unknown };
+
+// Left nib of the swing byte
+static constexpr FieldTable<VerticalSwing, 8> VERTICAL_SWING = {{
+    {0x0E, "Swing"},
+    {0x0F, "Auto"},
+    {0x01, "Top"},
+    {0x02, "Middle Top"},
+    {0x03, "Middle"},
+    {0x04, "Middle Bottom"},
+    {0x05, "Bottom"},
+    {0x00, "unsupported"},
+}};
+
+enum class HorizontalSwing : uint8_t { Swing, Left, CenterLeft, Center, CenterRight, Right, Unsupported, Unknown };
+
+// Right nib of the swing byte
+static constexpr FieldTable<HorizontalSwing, 7> HORIZONTAL_SWING = {{
+    {0x0D, "Swing"},
+    {0x09, "Left"},
+    {0x0A, "Center Left"},
+    {0x06, "Center"},
+    {0x0B, "Center Right"},
+    {0x0C, "Right"},
+    {0x00, "unsupported"},
+}};
+
+/*
+ * Frames
+ */
+
+// State block, bytes 2-11 of poll responses and control frames
+class StateBlock : public FrameReader<10> {
+ public:
+  constexpr StateBlock() = default;
+
+  // Returns false if the buffer is too short to hold the frame
+  static bool wrap(const uint8_t *data, size_t length, StateBlock *frame) {
+    if (length < SIZE)
+      return false;
+
+    *frame = StateBlock(data, length);
+    return true;
+  }
+
+  static StateBlock view(const FrameData<SIZE> &frame) { return StateBlock(frame.bytes, SIZE); }
+
+  // Fields in schema order, for code that handles them generically
+  enum Field : uint8_t {
+    FIELD_MODE,
+    FIELD_POWER,
+    FIELD_TARGET_TEMPERATURE,
+    FIELD_MILD_DRY,
+    FIELD_FAN_SPEED,
+    FIELD_VERTICAL_SWING,
+    FIELD_HORIZONTAL_SWING,
+    FIELD_PRESET,
+    FIELD_ECONAVI,
+    FIELD_NANOEX,
+    FIELD_ECO,
+    FIELD_COUNT,
+  };
+  static constexpr FieldMask FIELDS[FIELD_COUNT] = {
+      {0, 0xF0},  // mode
+      {0, 0x0F},  // power
+      {1, 0xFF},  // target_temperature
+      {2, 0xFF},  // mild_dry
+      {3, 0xFF},  // fan_speed
+      {4, 0xF0},  // vertical_swing
+      {4, 0x0F},  // horizontal_swing
+      {5, 0x0F},  // preset
+      {5, 0x10},  // econavi
+      {5, 0x40},  // nanoex
+      {8, 0xFF},  // eco
+  };
+
+  // Auto (0), dry (2), cool (3), heat (4), fan only (6)
+  constexpr uint8_t mode() const { return this->get_u8<0, 0xF0>(); }
+  constexpr uint8_t power() const { return this->get_u8<0, 0x0F>(); }  // Off (0), on (4)
+  constexpr uint8_t target_temperature() const { return this->get_u8<1>(); }  // Target temperature * 2
+  constexpr uint8_t mild_dry() const { return this->get_u8<2>(); }  // Off (80), on (7F)
+  constexpr uint8_t fan_speed() const { return this->get_u8<3>(); }  // Auto (A0), 1 (30) to 5 (70)
+  constexpr uint8_t vertical_swing() const { return this->get_u8<4, 0xF0>(); }  // See VERTICAL_SWING
+  constexpr uint8_t horizontal_swing() const { return this->get_u8<4, 0x0F>(); }  // See HORIZONTAL_SWING
+  constexpr uint8_t preset() const { return this->get_u8<5, 0x0F>(); }  // Normal (0), powerful (2), quiet (4)
+  constexpr bool econavi() const { return this->get_flag<5, 0x10>(); }
+  constexpr bool nanoex() const { return this->get_flag<5, 0x40>(); }
+  constexpr uint8_t eco() const { return this->get_u8<8>(); }  // Off (00), on (40)
+
+ protected:
+  friend class PollResponse;
+  constexpr StateBlock(const uint8_t *data, size_t length) : FrameReader(data, length) {}
+};
+
+using StateBlockData = FrameData<StateBlock::SIZE>;
+
+// State block, bytes 2-11 of poll responses and control frames
+class StateBlockWriter : public FrameWriter<10> {
+ public:
+  constexpr StateBlockWriter() = default;
+
+  // Returns false if the buffer is too short to hold the frame
+  static bool wrap(uint8_t *data, size_t length, StateBlockWriter *frame) {
+    if (length < SIZE)
+      return false;
+
+    *frame = StateBlockWriter(data, length);
+    return true;
+  }
+
+  static StateBlockWriter edit(FrameData<SIZE> &frame) { return StateBlockWriter(frame.bytes, SIZE); }
+
+  // Auto (0), dry (2), cool (3), heat (4), fan only (6)
+  constexpr uint8_t mode() const { return this->get_u8<0, 0xF0>(); }
+  constexpr uint8_t power() const { return this->get_u8<0, 0x0F>(); }  // Off (0), on (4)
+  constexpr uint8_t target_temperature() const { return this->get_u8<1>(); }  // Target temperature * 2
+  constexpr uint8_t mild_dry() const { return this->get_u8<2>(); }  // Off (80), on (7F)
+  constexpr uint8_t fan_speed() const { return this->get_u8<3>(); }  // Auto (A0), 1 (30) to 5 (70)
+  constexpr uint8_t vertical_swing() const { return this->get_u8<4, 0xF0>(); }  // See VERTICAL_SWING
+  constexpr uint8_t horizontal_swing() const { return this->get_u8<4, 0x0F>(); }  // See HORIZONTAL_SWING
+  constexpr uint8_t preset() const { return this->get_u8<5, 0x0F>(); }  // Normal (0), powerful (2), quiet (4)
+  constexpr bool econavi() const { return this->get_flag<5, 0x10>(); }
+  constexpr bool nanoex() const { return this->get_flag<5, 0x40>(); }
+  constexpr uint8_t eco() const { return this->get_u8<8>(); }  // Off (00), on (40)
+
+  void set_mode(uint8_t value) { this->set_u8<0, 0xF0>(value); }
+  void set_power(uint8_t value) { this->set_u8<0, 0x0F>(value); }
+  void set_target_temperature(uint8_t value) { this->set_u8<1>(value); }
+  void set_mild_dry(uint8_t value) { this->set_u8<2>(value); }
+  void set_fan_speed(uint8_t value) { this->set_u8<3>(value); }
+  void set_vertical_swing(uint8_t value) { this->set_u8<4, 0xF0>(value); }
+  void set_horizontal_swing(uint8_t value) { this->set_u8<4, 0x0F>(value); }
+  void set_preset(uint8_t value) { this->set_u8<5, 0x0F>(value); }
+  void set_econavi(bool value) { this->set_flag<5, 0x10>(value); }
+  void set_nanoex(bool value) { this->set_flag<5, 0x40>(value); }
+  void set_eco(uint8_t value) { this->set_u8<8>(value); }
+
+ protected:
+  constexpr StateBlockWriter(uint8_t *data, size_t length) : FrameWriter(data, length) {}
+};
+
+// Answer to a poll, AC to controller
+class PollResponse : public FrameReader<35> {
+ public:
+  constexpr PollResponse() = default;
+
+  // Returns false if the buffer is too short to hold the frame
+  static bool wrap(const uint8_t *data, size_t length, PollResponse *frame) {
+    if (length < SIZE)
+      return false;
+
+    *frame = PollResponse(data, length);
+    return true;
+  }
+
+  static PollResponse view(const FrameData<SIZE> &frame) { return PollResponse(frame.bytes, SIZE); }
+
+  constexpr int8_t inside_temperature() const { return this->get_i8<18>(); }  // 80 if not supported
+  constexpr int8_t outside_temperature() const { return this->get_i8<19>(); }  // 80 if not supported
+  // Used by units that report 80 in byte 18
+  constexpr int8_t inside_temperature_alt() const { return this->get_i8<21>(); }
+  // Used by units that report 80 in byte 19
+  constexpr int8_t outside_temperature_alt() const { return this->get_i8<22>(); }
+  constexpr uint16_t power() const { return this->get_u16le<28>(); }  // Power consumption plus power_offset, in W
+  constexpr uint8_t power_offset() const { return this->get_u8<30>(); }
+
+  StateBlock state() const {
+    static_assert(2 + 10 <= SIZE, "Block lies outside of its frame");
+    return StateBlock(this->data_ + 2, 10);
+  }
+
+ protected:
+  constexpr PollResponse(const uint8_t *data, size_t length) : FrameReader(data, length) {}
+};
+
+using PollResponseData = FrameData<PollResponse::SIZE>;
+
+}  // namespace CNT
+
+namespace WLAN {
+
+// DNSK-P11 protocol via CN-WLAN, see protocol_description_controller.ods
+
+/*
+ * Field tables, the enums list the values in table order
+ */
+
+enum class VerticalSwing : uint8_t { Up, UpCenter, Center, DownCenter, Down, Unknown };
+
+static constexpr FieldTable<VerticalSwing, 5> VERTICAL_SWING = {{
+    {0x41, "up"},
+    {0x44, "up_center"},
+    {0x43, "center"},
+    {0x45, "down_center"},
+    {0x42, "down"},
+}};
+
+enum class HorizontalSwing : uint8_t { Right, RightCenter, Center, LeftCenter, Left, Unknown };
+
+static constexpr FieldTable<HorizontalSwing, 5> HORIZONTAL_SWING = {{
+    {0x41, "right"},
+    {0x56, "right_center"},
+    {0x43, "center"},
+    {0x5C, "left_center"},
+    {0x42, "left"},
+}};
+
+enum class Preset : uint8_t { Normal, Powerful, Quiet, Unknown };
+
+static constexpr FieldTable<Preset, 3> PRESET = {{
+    {0x41, "Normal"},
+    {0x42, "Powerful"},
+    {0x43, "Quiet"},
+}};
+
+/*
+ * Keys of key value pairs
+ */
+
+static const uint8_t KEY_POWER = 0x80;                // On (30), off (31)
+static const uint8_t KEY_MODE = 0xB0;                 // Auto (41), cool (42), heat (43), dry (44), fan only (45)
+static const uint8_t KEY_TARGET_TEMPERATURE = 0x31;   // Target temperature * 2
+static const uint8_t KEY_FAN_SPEED = 0xA0;            // 1 (32) to 5 (36), auto (41)
+static const uint8_t KEY_SWING = 0xA1;                // Both (41), off (42), vertical (43), horizontal (44)
+static const uint8_t KEY_HORIZONTAL_SWING = 0xA5;     // See HORIZONTAL_SWING
+static const uint8_t KEY_VERTICAL_SWING = 0xA4;       // See VERTICAL_SWING
+static const uint8_t KEY_PRESET = 0xB2;               // See PRESET
+static const uint8_t KEY_NANOEX = 0x33;               // Off (42), on (45)
+static const uint8_t KEY_NANOEX_STATE = 0x20;         // Set by nanoex, meaning unknown
+static const uint8_t KEY_UNKNOWN_34 = 0x34;           // Sent as 42 with presets, meaning unknown
+static const uint8_t KEY_UNKNOWN_35 = 0x35;           // Sent as 42 with presets and swing off, meaning unknown
+static const uint8_t KEY_INSIDE_TEMPERATURE = 0xBB;   // Signed, in degrees
+static const uint8_t KEY_OUTSIDE_TEMPERATURE = 0xBE;  // Signed, in degrees
+
+/*
+ * Frames
+ */
+
+// Key value pair of set commands, entries with longer values are walked by esppac_registers.h
+class Pair : public FrameReader<4> {
+ public:
+  constexpr Pair() = default;
+
+  // Returns false if the buffer is too short to hold the frame
+  static bool wrap(const uint8_t *data, size_t length, Pair *frame) {
+    if (length < SIZE)
+      return false;
+
+    *frame = Pair(data, length);
+    return true;
+  }
+
+  static Pair view(const FrameData<SIZE> &frame) { return Pair(frame.bytes, SIZE); }
+
+  constexpr uint8_t key() const { return this->get_u8<0>(); }
+  constexpr uint8_t marker() const { return this->get_u8<1>(); }  // Length of the value, always 01 in set commands
+  constexpr uint8_t value() const { return this->get_u8<2>(); }
+  // 00, 01 or 02, overwritten by the checksum in the last pair
+  constexpr uint8_t extra() const { return this->get_u8<3>(); }
+
+ protected:
+  friend class KeyValue;
+  constexpr Pair(const uint8_t *data, size_t length) : FrameReader(data, length) {}
+};
+
+using PairData = FrameData<Pair::SIZE>;
+
+// Key value pair of set commands, entries with longer values are walked by esppac_registers.h
+class PairWriter : public FrameWriter<4> {
+ public:
+  constexpr PairWriter() = default;
+
+  // Returns false if the buffer is too short to hold the frame
+  static bool wrap(uint8_t *data, size_t length, PairWriter *frame) {
+    if (length < SIZE)
+      return false;
+
+    *frame = PairWriter(data, length);
+    return true;
+  }
+
+  static PairWriter edit(FrameData<SIZE> &frame) { return PairWriter(frame.bytes, SIZE); }
+
+  constexpr uint8_t key() const { return this->get_u8<0>(); }
+  constexpr uint8_t marker() const { return this->get_u8<1>(); }  // Length of the value, always 01 in set commands
+  constexpr uint8_t value() const { return this->get_u8<2>(); }
+  // 00, 01 or 02, overwritten by the checksum in the last pair
+  constexpr uint8_t extra() const { return this->get_u8<3>(); }
+
+  void set_key(uint8_t value) { this->set_u8<0>(value); }
+  void set_marker(uint8_t value) { this->set_u8<1>(value); }
+  void set_value(uint8_t value) { this->set_u8<2>(value); }
+  void set_extra(uint8_t value) { this->set_u8<3>(value); }
+
+ protected:
+  friend class KeyValueWriter;
+  constexpr PairWriter(uint8_t *data, size_t length) : FrameWriter(data, length) {}
+};
+
+// Header of frames carrying key value pairs: set commands, reports and query responses
+class KeyValue : public FrameReader<12> {
+ public:
+  constexpr KeyValue() = default;
+
+  // Returns false if the buffer is too short to hold the frame
+  static bool wrap(const uint8_t *data, size_t length, KeyValue *frame) {
+    if (length < SIZE)
+      return false;
+
+    *frame = KeyValue(data, length);
+    return true;
+  }
+
+  static KeyValue view(const FrameData<SIZE> &frame) { return KeyValue(frame.bytes, SIZE); }
+
+  // Set (1008), report (100A), query response (1089)
+  constexpr uint16_t packet_type() const { return this->get_u16be<2>(); }
+  // Length of everything after this field, without the checksum
+  constexpr uint16_t payload_length() const { return this->get_u16be<4>(); }
+  constexpr uint8_t direction() const { return this->get_u8<6>(); }  // To AC (01), from AC (00)
+  constexpr uint8_t marker() const { return this->get_u8<7>(); }  // Always 01
+  constexpr uint16_t pair_header() const { return this->get_u16be<8>(); }  // Always 3001
+  constexpr uint8_t pair_count() const { return this->get_u8<10>(); }
+
+  // Number of pairs, clamped to the ones that fit into the buffer
+  size_t pairs_size() const {
+    static_assert(12 <= SIZE, "Records lie outside of their frame");
+    size_t fits = (this->length_ - 12) / 4;
+    return std::min<size_t>(this->pair_count(), fits);
+  }
+
+  // Record at index, or a default constructed one if index is past pairs_size()
+  Pair pairs_at(size_t index) const {
+    if (index >= this->pairs_size())
+      return Pair();
+
+    return Pair(this->data_ + 12 + index * 4, 4);
+  }
+
+ protected:
+  constexpr KeyValue(const uint8_t *data, size_t length) : FrameReader(data, length) {}
+};
+
+using KeyValueData = FrameData<KeyValue::SIZE>;
+
+// Header of frames carrying key value pairs: set commands, reports and query responses
+class KeyValueWriter : public FrameWriter<12> {
+ public:
+  constexpr KeyValueWriter() = default;
+
+  // Returns false if the buffer is too short to hold the frame
+  static bool wrap(uint8_t *data, size_t length, KeyValueWriter *frame) {
+    if (length < SIZE)
+      return false;
+
+    *frame = KeyValueWriter(data, length);
+    return true;
+  }
+
+  static KeyValueWriter edit(FrameData<SIZE> &frame) { return KeyValueWriter(frame.bytes, SIZE); }
+
+  // Set (1008), report (100A), query response (1089)
+  constexpr uint16_t packet_type() const { return this->get_u16be<2>(); }
+  // Length of everything after this field, without the checksum
+  constexpr uint16_t payload_length() const { return this->get_u16be<4>(); }
+  constexpr uint8_t direction() const { return this->get_u8<6>(); }  // To AC (01), from AC (00)
+  constexpr uint8_t marker() const { return this->get_u8<7>(); }  // Always 01
+  constexpr uint16_t pair_header() const { return this->get_u16be<8>(); }  // Always 3001
+  constexpr uint8_t pair_count() const { return this->get_u8<10>(); }
+
+  void set_packet_type(uint16_t value) { this->set_u16be<2>(value); }
+  void set_payload_length(uint16_t value) { this->set_u16be<4>(value); }
+  void set_direction(uint8_t value) { this->set_u8<6>(value); }
+  void set_marker(uint8_t value) { this->set_u8<7>(value); }
+  void set_pair_header(uint16_t value) { this->set_u16be<8>(value); }
+  void set_pair_count(uint8_t value) { this->set_u8<10>(value); }
+
+  // Number of pairs, clamped to the ones that fit into the buffer
+  size_t pairs_size() const {
+    static_assert(12 <= SIZE, "Records lie outside of their frame");
+    size_t fits = (this->length_ - 12) / 4;
+    return std::min<size_t>(this->pair_count(), fits);
+  }
+
+  // Record at index, returns false if index is past pairs_size()
+  bool pairs_at(size_t index, PairWriter *record) const {
+    if (index >= this->pairs_size())
+      return false;
+
+    *record = PairWriter(this->mutable_data_ + 12 + index * 4, 4);
+    return true;
+  }
+
+ protected:
+  constexpr KeyValueWriter(uint8_t *data, size_t length) : FrameWriter(data, length) {}
+};
+
+}  // namespace WLAN
+
+}  // namespace panasonic_ac
+}  // namespace esphome
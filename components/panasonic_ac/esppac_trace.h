@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace panasonic_ac {
+
+static const size_t TRACE_HEADER_SIZE = 7;  // Time in us as u32le, TraceFlag bits, frame length as u16le
+
+enum TraceFlag : uint8_t {
+  TRACE_OUTGOING = 1 << 0,  // Written by the component, otherwise received from the AC
+};
+
+/*
+ * Binary trace of the last frames on the link, in a byte ring of N bytes, N must be a power of two
+ *
+ * Every record is a TRACE_HEADER_SIZE byte header followed by the frame. The oldest records are dropped to make room,
+ * so the ring always holds the most recent frames. Appending costs two memcpy calls, decoding is left to dump readers
+ * such as host/trace/trace_decode.
+ */
+template<size_t N> class TraceRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "Trace ring capacity must be a power of two");
+
+ public:
+  size_t size() const { return this->head_ - this->tail_; }
+  size_t records() const { return this->records_; }
+  bool frozen() const { return this->frozen_; }
+  static constexpr size_t capacity() { return N; }
+
+  // Stops recording, so the frames leading up to an error are kept until resume()
+  void freeze() { this->frozen_ = true; }
+  void resume() { this->frozen_ = false; }
+
+  void clear() {
+    this->head_ = this->tail_ = 0;
+    this->records_ = 0;
+  }
+
+  void append(uint32_t time, uint8_t flags, const uint8_t *data, size_t length) {
+    if (this->frozen_ || TRACE_HEADER_SIZE + length > N)
+      return;
+
+    while (N - this->size() < TRACE_HEADER_SIZE + length)
+      this->drop_oldest();
+
+    const uint8_t header[TRACE_HEADER_SIZE] = {
+        uint8_t(time), uint8_t(time >> 8), uint8_t(time >> 16), uint8_t(time >> 24),
+        flags,         uint8_t(length),    uint8_t(length >> 8),
+    };
+
+    this->write(header, TRACE_HEADER_SIZE);
+    this->write(data, length);
+    this->records_++;
+  }
+
+  // Byte at the given position counted from the start of the oldest record
+  uint8_t peek(size_t index) const { return this->data_[(this->tail_ + index) & MASK]; }
+
+ protected:
+  static constexpr size_t MASK = N - 1;
+
+  void write(const uint8_t *data, size_t length) {
+    size_t offset = this->head_ & MASK;
+    size_t first = length < N - offset ? length : N - offset;
+
+    std::memcpy(this->data_ + offset, data, first);
+    std::memcpy(this->data_, data + first, length - first);
+    this->head_ += length;
+  }
+
+  void drop_oldest() {
+    size_t length = this->peek(5) | (this->peek(6) << 8);
+    this->tail_ += TRACE_HEADER_SIZE + length;
+    this->records_--;
+  }
+
+  uint8_t data_[N];
+  size_t head_ = 0;  // Free-running write index
+  size_t tail_ = 0;  // Free-running index of the oldest record
+  size_t records_ = 0;
+  bool frozen_ = false;
+};
+
+}  // namespace panasonic_ac
+}  // namespace esphome
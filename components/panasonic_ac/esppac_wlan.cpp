@@ -7,12 +7,51 @@ namespace WLAN {
 
 static const char *const TAG = "panasonic_ac.dnskp11";
 
+// Index of a key in INTENT_KEYS, -1 if requests for it are not tracked
+static int intent_field(uint8_t key) {
+  for (size_t i = 0; i < sizeof(INTENT_KEYS); i++) {
+    if (INTENT_KEYS[i] == key)
+      return i;
+  }
+
+  return -1;
+}
+
+// Writes the packet counter and the checksum, which is calculated by adding all bytes together
+static void finish_packet(uint8_t *data, size_t length, uint8_t counter) {
+  data[1] = counter;
+
+  uint8_t checksum = 0;
+  for (size_t i = 0; i < length - 1; i++)
+    checksum += data[i];
+
+  data[length - 1] = ~checksum + 1;
+}
+
 void PanasonicACWLAN::setup() {
   PanasonicAC::setup();
 
+  this->tx_frame_gap_ = TX_FRAME_GAP;
+
+  // A session that outlived the module is resumed with its counters instead of doing the whole handshake again,
+  // the key includes the entity so several climates on one node keep their own
+  this->session_pref_ = global_preferences->make_preference<SessionState>(fnv1_hash("panasonic_ac_wlan_session") ^
+                                                                          this->get_object_id_hash());
+
+  SessionState session;
+  if (this->session_pref_.load(&session)) {
+    this->transmit_packet_count_ = session.transmit_packet_count;
+    this->receive_packet_count_ = session.receive_packet_count;
+    this->has_session_ = true;
+  }
+
   ESP_LOGD(TAG, "Using DNSK-P11 protocol via CN-WLAN");
 }
 
+void PanasonicACWLAN::on_safe_shutdown() {
+  handle_session(true);  // Store the current counters, the AC expects them to continue after the restart
+}
+
 void PanasonicACWLAN::loop() {
   if (this->state_ != ACState::Ready) {
     handle_init_packets();  // Handle initialization packets separate from normal packets
@@ -24,28 +63,25 @@ void PanasonicACWLAN::loop() {
     }
   }
 
-  if (millis() - this->last_read_ > READ_TIMEOUT &&
-      !this->rx_buffer_.empty())  // Check if our read timed out and we received something
+  while (read_packet())  // Handle every packet that was completed since the last loop
   {
     log_packet(this->rx_buffer_);
 
     if (!verify_packet())  // Verify length, header, counter and checksum
-      return;
+      continue;
 
     this->waiting_for_response_ =
         false;  // Set that we are not waiting for a response anymore since we received a valid one
     this->last_packet_received_ = millis();  // Set the time at which we received our last packet
 
-    if (this->state_ == ACState::Ready || this->state_ == ACState::FirstPoll ||
-        this->state_ == ACState::HandshakeEnding)  // Parse regular packets
+    if (this->state_ == ACState::Handshake)  // Parse handshake packets
     {
-      handle_packet();  // Handle regular packet
-    } else              // Parse handshake packets
+      this->step_time_ = millis();  // Every answer moves the handshake on
+      handle_handshake_packet();    // Not initialized yet, handle handshake packet
+    } else                          // Parse regular packets
     {
-      handle_handshake_packet();  // Not initialized yet, handle handshake packet
+      handle_packet();  // Handle regular packet
     }
-
-    this->rx_buffer_.clear();  // Reset buffer
   }
 
   PanasonicAC::read_data();
@@ -53,6 +89,16 @@ void PanasonicACWLAN::loop() {
   handle_resend();  // Handle packets that need to be resent
 
   handle_poll();  // Handle sending poll packets
+
+  // Retry a set command the transmit queue had no room for
+  if (this->set_queue_index_ > 0 && this->state_ == ACState::Ready && !this->tx_queue_.full())
+    send_set_command();
+
+  handle_tx();  // Write the next queued frame once the line is free
+
+  handle_session(false);  // Keep the counters in flash current in case the module resets without warning
+  publish_pending();      // Publish what changed during this loop
+  publish_raw_sensors();
 }
 
 /*
@@ -68,36 +114,33 @@ void PanasonicACWLAN::control(const climate::ClimateCall &call) {
 
     switch (*call.get_mode()) {
       case climate::CLIMATE_MODE_COOL:
-        set_value(0xB0, 0x42);
-        set_value(0x80, 0x30);
+        set_value(KEY_MODE, 0x42);
+        set_value(KEY_POWER, 0x30);
         break;
       case climate::CLIMATE_MODE_HEAT:
-        set_value(0xB0, 0x43);
-        set_value(0x80, 0x30);
+        set_value(KEY_MODE, 0x43);
+        set_value(KEY_POWER, 0x30);
         break;
       case climate::CLIMATE_MODE_DRY:
-        set_value(0xB0, 0x44);
-        set_value(0x80, 0x30);
+        set_value(KEY_MODE, 0x44);
+        set_value(KEY_POWER, 0x30);
         break;
       case climate::CLIMATE_MODE_HEAT_COOL:
-        set_value(0xB0, 0x41);
-        set_value(0x80, 0x30);
+        set_value(KEY_MODE, 0x41);
+        set_value(KEY_POWER, 0x30);
         break;
       case climate::CLIMATE_MODE_FAN_ONLY:
-        set_value(0xB0, 0x45);
-        set_value(0x80, 0x30);
+        set_value(KEY_MODE, 0x45);
+        set_value(KEY_POWER, 0x30);
         break;
       case climate::CLIMATE_MODE_OFF:
-        set_value(0x80, 0x31);
+        set_value(KEY_POWER, 0x31);
         break;
       default:
         ESP_LOGV(TAG, "Unsupported mode requested");
         break;
     }
 
-    this->mode =
-        *call.get_mode();   // Set mode manually since we won't receive a report from the AC if its the same mode again
-    this->publish_state();  // Send this state, will get updated once next poll is executed
   }
   
   if (call.get_fan_mode().has_value()) {
@@ -105,42 +148,38 @@ void PanasonicACWLAN::control(const climate::ClimateCall &call) {
 
     switch (*call.get_fan_mode()) {
       case climate::CLIMATE_FAN_AUTO:
-        set_value(0xB2, 0x41);
-        set_value(0xA0, 0x41);
+        set_value(KEY_PRESET, PRESET.encode(Preset::Normal));
+        set_value(KEY_FAN_SPEED, 0x41);
         break;
       case climate::CLIMATE_FAN_DIFFUSE:
-        set_value(0xB2, 0x41);
-        set_value(0xA0, 0x32);
+        set_value(KEY_PRESET, PRESET.encode(Preset::Normal));
+        set_value(KEY_FAN_SPEED, 0x32);
         break;
       case climate::CLIMATE_FAN_LOW:
-        set_value(0xB2, 0x41);
-        set_value(0xA0, 0x33);
+        set_value(KEY_PRESET, PRESET.encode(Preset::Normal));
+        set_value(KEY_FAN_SPEED, 0x33);
         break;
       case climate::CLIMATE_FAN_MEDIUM:
-        set_value(0xB2, 0x41);
-        set_value(0xA0, 0x34);
+        set_value(KEY_PRESET, PRESET.encode(Preset::Normal));
+        set_value(KEY_FAN_SPEED, 0x34);
         break;
       case climate::CLIMATE_FAN_HIGH:
-        set_value(0xB2, 0x41);
-        set_value(0xA0, 0x35);
+        set_value(KEY_PRESET, PRESET.encode(Preset::Normal));
+        set_value(KEY_FAN_SPEED, 0x35);
         break;
       case climate::CLIMATE_FAN_FOCUS:
-        set_value(0xB2, 0x41);
-        set_value(0xA0, 0x36);
+        set_value(KEY_PRESET, PRESET.encode(Preset::Normal));
+        set_value(KEY_FAN_SPEED, 0x36);
         break;
       default:
         ESP_LOGV(TAG, "Unsupported fan mode requested");
         break;
     }
-
-    this->fan_mode =
-        *call.get_fan_mode();
-    this->publish_state();
   }
   
   if (call.get_target_temperature().has_value()) {
     ESP_LOGV(TAG, "Requested temperature change");
-    set_value(0x31, *call.get_target_temperature() * 2);
+    set_value(KEY_TARGET_TEMPERATURE, *call.get_target_temperature() * 2);
   }
 
   if (call.get_swing_mode().has_value()) {
@@ -148,21 +187,21 @@ void PanasonicACWLAN::control(const climate::ClimateCall &call) {
 
     switch (*call.get_swing_mode()) {
       case climate::CLIMATE_SWING_BOTH:
-        set_value(0xA1, 0x41);
+        set_value(KEY_SWING, 0x41);
         break;
       case climate::CLIMATE_SWING_OFF:
-        set_value(0xA1, 0x42);
-        set_value(0xA4, 0x43);
-        set_value(0xA5, 0x43);
-        set_value(0x35, 0x42);
+        set_value(KEY_SWING, 0x42);
+        set_value(KEY_VERTICAL_SWING, VERTICAL_SWING.encode(VerticalSwing::Center));
+        set_value(KEY_HORIZONTAL_SWING, HORIZONTAL_SWING.encode(HorizontalSwing::Center));
+        set_value(KEY_UNKNOWN_35, 0x42);
         break;
       case climate::CLIMATE_SWING_VERTICAL:
-        set_value(0xA1, 0x43);
-        set_value(0xA5, 0x43);
+        set_value(KEY_SWING, 0x43);
+        set_value(KEY_HORIZONTAL_SWING, HORIZONTAL_SWING.encode(HorizontalSwing::Center));
         break;
       case climate::CLIMATE_SWING_HORIZONTAL:
-        set_value(0xA1, 0x44);
-        set_value(0xA4, 0x43);
+        set_value(KEY_SWING, 0x44);
+        set_value(KEY_VERTICAL_SWING, VERTICAL_SWING.encode(VerticalSwing::Center));
         break;
       default:
         ESP_LOGV(TAG, "Unsupported swing mode requested");
@@ -173,20 +212,12 @@ void PanasonicACWLAN::control(const climate::ClimateCall &call) {
   if (call.get_custom_preset().has_value()) {
     ESP_LOGV(TAG, "Requested preset change");
 
-    std::string preset = *call.get_custom_preset();
-
-    if (preset.compare("Normal") == 0) {
-      set_value(0xB2, 0x41);
-      set_value(0x35, 0x42);
-      set_value(0x34, 0x42);
-    } else if (preset.compare("Powerful") == 0) {
-      set_value(0xB2, 0x42);
-      set_value(0x35, 0x42);
-      set_value(0x34, 0x42);
-    } else if (preset.compare("Quiet") == 0) {
-      set_value(0xB2, 0x43);
-      set_value(0x35, 0x42);
-      set_value(0x34, 0x42);
+    Preset preset;
+
+    if (PRESET.parse(*call.get_custom_preset(), &preset)) {
+      set_value(KEY_PRESET, PRESET.encode(preset));
+      set_value(KEY_UNKNOWN_35, 0x42);
+      set_value(KEY_UNKNOWN_34, 0x42);
     } else
       ESP_LOGV(TAG, "Unsupported preset requested");
   }
@@ -202,55 +233,148 @@ void PanasonicACWLAN::control(const climate::ClimateCall &call) {
  */
 
 void PanasonicACWLAN::handle_poll() {
-  if (this->state_ == ACState::Ready && millis() - this->last_packet_sent_ > POLL_INTERVAL) {
+  if (this->state_ == ACState::Ready && this->tx_queue_.empty() && millis() - this->last_packet_sent_ > POLL_INTERVAL) {
     ESP_LOGV(TAG, "Polling AC");
-    send_command(CMD_POLL, sizeof(CMD_POLL));
+    send_command(CMD_POLL, sizeof(CMD_POLL), CommandType::Normal, TxPriority::Poll);
   }
 }
 
+/*
+ * Whether the query response in the buffer equals the last one handled, apart from the packet counter and checksum
+ */
+bool PanasonicACWLAN::is_unchanged_query() {
+  // Pending requests need the full handling, it confirms them or lets them time out
+  if (this->intents_.any_pending() || this->rx_buffer_.size() != this->last_query_.size())
+    return false;
+
+  return std::equal(this->rx_buffer_.begin() + 2, this->rx_buffer_.end() - 1, this->last_query_.begin() + 2);
+}
+
+/*
+ * Steps of the initialization that are not answers to a packet of the AC, the others advance in
+ * handle_handshake_packet() and handle_packet() as soon as the answer arrives
+ */
 void PanasonicACWLAN::handle_init_packets() {
-  if (this->state_ == ACState::Initializing) {
-    if (millis() - this->init_time_ > INIT_TIMEOUT)  // Handle handshake initialization
-    {
-      ESP_LOGD(TAG, "Starting handshake [1/16]");
-      send_command(CMD_HANDSHAKE_1,
-                   sizeof(CMD_HANDSHAKE_1));  // Send first handshake packet, AC won't send a response
-      delay(3);                               // Add small delay to mimic real wifi adapter
-      send_command(CMD_HANDSHAKE_2,
-                   sizeof(CMD_HANDSHAKE_2));  // Send second handshake packet, AC won't send a response
-                                              // but we will trigger a resend
-
-      this->state_ = ACState::Handshake;  // Update state to handshake started
-    }
-  } else if (this->state_ == ACState::FirstPoll &&
-             millis() - this->last_packet_sent_ > FIRST_POLL_TIMEOUT)  // Handle sending first poll
-  {
-    ESP_LOGD(TAG, "Polling for the first time");
-    send_command(CMD_POLL, sizeof(CMD_POLL));
+  if (!this->tx_queue_.empty())
+    return;  // Steps start once the previous packet is written
 
-    this->state_ = ACState::HandshakeEnding;
-  } else if (this->state_ == ACState::HandshakeEnding &&
-             millis() - this->last_packet_sent_ > INIT_END_TIMEOUT)  // Handle last handshake message
-  {
-    ESP_LOGD(TAG, "Finishing handshake [16/16]");
-    send_command(CMD_HANDSHAKE_16, sizeof(CMD_HANDSHAKE_16));
+  switch (this->state_) {
+    case ACState::Initializing:
+      if (millis() - this->init_time_ <= INIT_DELAY)
+        break;
 
-    // State is set to ready in the response to this packet
+      if (this->has_session_) {
+        ESP_LOGD(TAG, "Resuming previous session");
+        send_command(CMD_POLL, sizeof(CMD_POLL), CommandType::Normal, TxPriority::Poll);
+
+        this->state_ = ACState::Resuming;  // State is set to ready in the response to this poll
+        this->step_time_ = millis();
+      } else {
+        start_handshake();
+      }
+      break;
+    case ACState::Resuming:
+      if (millis() - this->step_time_ > RESUME_TIMEOUT) {
+        ESP_LOGI(TAG, "Previous session was not resumed");
+        start_handshake();
+      }
+      break;
+    case ACState::FirstPoll:
+      if (millis() - this->last_packet_sent_ <= FIRST_POLL_DELAY)
+        break;
+
+      ESP_LOGD(TAG, "Polling for the first time");
+      send_command(CMD_POLL, sizeof(CMD_POLL), CommandType::Normal, TxPriority::Poll);
+
+      this->state_ = ACState::HandshakeEnding;  // The last handshake packet follows the response to this poll
+      this->step_time_ = millis();
+      break;
+    case ACState::Handshake:
+      // Lost packets are resent first, a step still unanswered after STEP_TIMEOUT starts the handshake over
+      if (millis() - this->step_time_ > STEP_TIMEOUT) {
+        ESP_LOGW(TAG, "Handshake step was not answered, starting over");
+        start_handshake();
+      }
+      break;
+    case ACState::HandshakeEnding:
+      // Once the first poll is answered the AC knows the module, from there on the last step is only resent
+      break;
+    default:
+      break;
   }
 }
 
+void PanasonicACWLAN::start_handshake() {
+  ESP_LOGD(TAG, "Starting handshake [1/16]");
+  this->transmit_packet_count_ = 0;  // The handshake counts from zero, like after a cold boot
+
+  // Both are queued, TX_FRAME_GAP keeps the small gap between them the real wifi adapter has
+  send_command(CMD_HANDSHAKE_1,
+               sizeof(CMD_HANDSHAKE_1));  // Send first handshake packet, AC won't send a response
+  send_command(CMD_HANDSHAKE_2,
+               sizeof(CMD_HANDSHAKE_2));  // Send second handshake packet, AC won't send a response
+                                          // but we will trigger a resend
+
+  this->state_ = ACState::Handshake;  // Update state to handshake started
+  this->step_time_ = millis();
+}
+
+void PanasonicACWLAN::set_ready() {
+  ESP_LOGI(TAG, "Panasonic AC component v%s initialized", VERSION);
+  this->state_ = ACState::Ready;
+
+  handle_session(true);
+}
+
+/*
+ * Keep the counters of the session in flash, written at most once per SESSION_WRITE_INTERVAL to spare the flash
+ */
+void PanasonicACWLAN::handle_session(bool force) {
+  if (this->state_ != ACState::Ready)
+    return;
+
+  SessionState session{this->transmit_packet_count_, this->receive_packet_count_};
+  if (this->session_writes_ > 0 && session.transmit_packet_count == this->saved_session_.transmit_packet_count &&
+      session.receive_packet_count == this->saved_session_.receive_packet_count)
+    return;
+
+  if (!force && this->session_writes_ > 0 && millis() - this->session_written_ < SESSION_WRITE_INTERVAL)
+    return;
+
+  ESP_LOGV(TAG, "Writing session");
+  this->session_pref_.save(&session);
+  this->saved_session_ = session;
+  this->session_written_ = millis();
+  this->session_writes_++;
+}
+
+/*
+ * Packet framing
+ */
+
+bool PanasonicACWLAN::is_packet_header(uint8_t byte) { return byte == HEADER || byte == SYNC_HEADER; }
+
+size_t PanasonicACWLAN::packet_length() {
+  if (this->rx_buffer_[0] == SYNC_HEADER || this->rx_buffer_.size() < 6)
+    return 0;  // Sync packets are completed by the idle gap
+
+  // Payload length plus header, packet counter, packet type, length and checksum
+  return ((this->rx_buffer_[4] << 8) | this->rx_buffer_[5]) + 7;
+}
+
 bool PanasonicACWLAN::verify_packet() {
   if (this->rx_buffer_.size() < 5)  // Drop packets that are too short
   {
     ESP_LOGW(TAG, "Dropping invalid packet (length)");
+    this->link_error(LINK_DROPS_LENGTH);
     this->rx_buffer_.clear();  // Reset buffer
     return false;
   }
 
-  if (this->rx_buffer_[0] == 0x66)  // Sync packets are the only packet not starting with 0x5A
+  if (this->rx_buffer_[0] == SYNC_HEADER)  // Sync packets are the only packet not starting with 0x5A
   {
     ESP_LOGI(TAG, "Received sync packet, triggering initialization");
-    this->init_time_ -= INIT_TIMEOUT;  // Set init time back to trigger a initialization now
+    this->init_time_ -= INIT_DELAY;  // Set init time back to trigger a initialization now
     this->rx_buffer_.clear();          // Reset buffer
     return false;
   }
@@ -258,6 +382,7 @@ bool PanasonicACWLAN::verify_packet() {
   if (this->rx_buffer_[0] != HEADER)  // Check if header matches
   {
     ESP_LOGW(TAG, "Dropping invalid packet (header)");
+    this->link_error(LINK_DROPS_HEADER);
     this->rx_buffer_.clear();  // Reset buffer
     return false;
   }
@@ -269,6 +394,7 @@ bool PanasonicACWLAN::verify_packet() {
         this->rx_buffer_[1] != 0xFE)  // Check transmit packet counter
     {
       ESP_LOGW(TAG, "Correcting shifted tx counter");
+      this->link_error(LINK_COUNTER_CORRECTIONS);
       this->receive_packet_count_ = this->rx_buffer_[1];
     }
   } else if (this->state_ == ACState::Ready)  // If we were not waiting for a response, check if the rx packet counter
@@ -277,6 +403,7 @@ bool PanasonicACWLAN::verify_packet() {
     if (this->rx_buffer_[1] != this->receive_packet_count_)  // Check receive packet counter
     {
       ESP_LOGW(TAG, "Correcting shifted rx counter");
+      this->link_error(LINK_COUNTER_CORRECTIONS);
       this->receive_packet_count_ = this->rx_buffer_[1];
     }
   }
@@ -289,6 +416,7 @@ bool PanasonicACWLAN::verify_packet() {
   if (checksum != 0)  // Check if checksum is valid
   {
     ESP_LOGD(TAG, "Dropping invalid packet (checksum)");
+    this->link_error(LINK_DROPS_CHECKSUM);
 
     this->rx_buffer_.clear();  // Reset buffer
     return false;
@@ -301,6 +429,148 @@ bool PanasonicACWLAN::verify_packet() {
  * Field handling
  */
 
+/*
+ * Store the entries of the report or query response in the buffer, returns false if it is cut off
+ */
+bool PanasonicACWLAN::update_registers() {
+  uint32_t now = millis();
+
+  return walk_entries(this->rx_buffer_.data(), this->rx_buffer_.size(),
+                      [this, now](uint8_t key, const uint8_t *value, size_t length) {
+                        if (length > 0)
+                          this->registers_.update(key, value[0], now);
+                        if (this->raw_sensor_count_ > 0)
+                          update_raw_sensors(key, value, length);
+                      });
+}
+
+/*
+ * Apply the registers that changed with the last frame, and the ones a pending request waits for, which it confirms or
+ * lets time out
+ *
+ * Power and mode are applied together, the mode only shows while the power is on.
+ */
+void PanasonicACWLAN::apply_registers() {
+  bool power_or_mode = false;
+
+  auto apply = [this, &power_or_mode](uint8_t key) {
+    if (key == KEY_POWER || key == KEY_MODE)
+      power_or_mode = true;
+    else
+      apply_value(key, reconcile(key, this->registers_.value(key)));
+  };
+
+  this->registers_.for_each_changed(apply);
+
+  for (size_t i = 0; i < sizeof(INTENT_KEYS); i++) {
+    if (this->intents_.is_pending(i) && !this->registers_.changed(INTENT_KEYS[i]))
+      apply(INTENT_KEYS[i]);
+  }
+
+  this->registers_.clear_changes();
+
+  if (!power_or_mode)
+    return;
+
+  // Fields with a pending request keep the requested value until the AC reports it or the request times out
+  uint8_t power = reconcile(KEY_POWER, this->registers_.value(KEY_POWER));
+
+  if (power == 0x31 || !this->registers_.seen(KEY_MODE))
+    apply_value(KEY_POWER, power);
+  else
+    apply_value(KEY_MODE, reconcile(KEY_MODE, this->registers_.value(KEY_MODE)));
+}
+
+/*
+ * Apply the value of a key value pair to the state
+ */
+void PanasonicACWLAN::apply_value(uint8_t key, uint8_t value) {
+  switch (key) {
+    case KEY_POWER:  // Power mode
+      switch (value) {
+        case 0x30:  // Power mode on
+          ESP_LOGV(TAG, "Received power mode on");
+          // Ignore power on and let mode be set by other report
+          break;
+        case 0x31:  // Power mode off
+          ESP_LOGV(TAG, "Received power mode off");
+          this->mode = climate::CLIMATE_MODE_OFF;
+          break;
+        default:
+          ESP_LOGW(TAG, "Received unknown power mode");
+          break;
+      }
+      break;
+    case KEY_MODE:  // Mode
+      this->mode = determine_mode(value);
+      break;
+    case KEY_TARGET_TEMPERATURE:  // Target temperature
+      ESP_LOGV(TAG, "Received target temperature");
+      update_target_temperature((int8_t) value);
+      break;
+    case KEY_FAN_SPEED:  // Fan mode
+      ESP_LOGV(TAG, "Received fan mode");
+      this->fan_mode = determine_fan_mode(value);
+      break;
+    case KEY_PRESET: // Preset
+      ESP_LOGV(TAG, "Received preset");
+      update_custom_preset(determine_preset(value));
+      break;
+    case KEY_SWING:
+      ESP_LOGV(TAG, "Received swing mode");
+      this->swing_mode = determine_swing(value);
+      break;
+    case KEY_HORIZONTAL_SWING:  // Horizontal swing position
+      ESP_LOGV(TAG, "Received horizontal swing position");
+
+      update_swing_horizontal(HORIZONTAL_SWING.label(determine_swing_horizontal(value)));
+      break;
+    case KEY_VERTICAL_SWING:  // Vertical swing position
+      ESP_LOGV(TAG, "Received vertical swing position");
+
+      update_swing_vertical(VERTICAL_SWING.label(determine_swing_vertical(value)));
+      break;
+    case KEY_NANOEX:  // nanoex mode
+      ESP_LOGV(TAG, "Received nanoex state");
+
+      update_nanoex(determine_nanoex(value));
+      break;
+    case KEY_NANOEX_STATE:
+      ESP_LOGV(TAG, "Received unknown nanoex field");
+      // Not sure what this one, ignore it for now
+      break;
+    case KEY_INSIDE_TEMPERATURE:
+      update_current_temperature((int8_t) value);
+      break;
+    case KEY_OUTSIDE_TEMPERATURE:
+      update_outside_temperature((int8_t) value);
+      break;
+    case KEY_UNKNOWN_34:
+    case KEY_UNKNOWN_35:
+      break;  // Sent along with presets, meaning unknown
+    default:
+      ESP_LOGV(TAG, "Keeping unknown key 0x%02X", key);  // Stays in the register file
+      break;
+  }
+}
+
+/*
+ * Value to use for a reported key, the requested one while the AC has not applied a pending request
+ */
+uint8_t PanasonicACWLAN::reconcile(uint8_t key, uint8_t value) {
+  int field = intent_field(key);
+  if (field < 0)
+    return value;
+
+  uint32_t timed_out = this->intents_.get_timed_out();
+  value = this->intents_.reconcile(field, value, millis());
+
+  if (this->intents_.get_timed_out() != timed_out)
+    this->command_timed_out_ = true;
+
+  return value;
+}
+
 climate::ClimateMode PanasonicACWLAN::determine_mode(uint8_t mode) {
   switch (mode)  // Check mode
   {
@@ -341,54 +611,37 @@ climate::ClimateFanMode PanasonicACWLAN::determine_fan_mode(uint8_t fan_mode) {
   }
 }
 
-std::string PanasonicACWLAN::determine_preset(uint8_t preset) {
-  switch (preset) {
-    case 0x43:  // Quiet
-      return "Quiet";
-    case 0x42:  // Powerful
-      return "Powerful";
-    case 0x41:  // Normal
-      return "Normal";
-    default:
-      ESP_LOGW(TAG, "Received unknown preset");
-      return "Normal";
+Preset PanasonicACWLAN::determine_preset(uint8_t preset) {
+  Preset value;
+
+  if (!PRESET.decode(preset, &value)) {
+    ESP_LOGW(TAG, "Received unknown preset");
+    return Preset::Normal;
   }
+
+  return value;
 }
 
-std::string PanasonicACWLAN::determine_swing_vertical(uint8_t swing) {
-  switch (swing) {
-    case 0x42:  // Down
-      return "down";
-    case 0x45:  // Down center
-      return "down_center";
-    case 0x43:  // Center
-      return "center";
-    case 0x44:  // Up Center
-      return "up_center";
-    case 0x41:  // Up
-      return "up";
-    default:
-      ESP_LOGW(TAG, "Received unknown vertical swing position");
-      return "Unknown";
+VerticalSwing PanasonicACWLAN::determine_swing_vertical(uint8_t swing) {
+  VerticalSwing position;
+
+  if (!VERTICAL_SWING.decode(swing, &position)) {
+    ESP_LOGW(TAG, "Received unknown vertical swing position");
+    return VerticalSwing::Unknown;
   }
+
+  return position;
 }
 
-std::string PanasonicACWLAN::determine_swing_horizontal(uint8_t swing) {
-  switch (swing) {
-    case 0x42:  // Left
-      return "left";
-    case 0x5C:  // Left center
-      return "left_center";
-    case 0x43:  // Center
-      return "center";
-    case 0x56:  // Right center
-      return "right_center";
-    case 0x41:  // Right
-      return "right";
-    default:
-      ESP_LOGW(TAG, "Received unknown horizontal swing position");
-      return "Unknown";
+HorizontalSwing PanasonicACWLAN::determine_swing_horizontal(uint8_t swing) {
+  HorizontalSwing position;
+
+  if (!HORIZONTAL_SWING.decode(swing, &position)) {
+    ESP_LOGW(TAG, "Received unknown horizontal swing position");
+    return HorizontalSwing::Unknown;
   }
+
+  return position;
 }
 
 climate::ClimateSwingMode PanasonicACWLAN::determine_swing(uint8_t swing) {
@@ -416,6 +669,51 @@ bool PanasonicACWLAN::determine_nanoex(uint8_t nanoex) {
   }
 }
 
+/*
+ * Raw register sensors
+ */
+
+void PanasonicACWLAN::add_raw_sensor(uint8_t key, RawType type, float scale, uint8_t offset, sensor::Sensor *sensor) {
+  static_assert(RAW_SENSORS_MAX <= 16, "raw_dirty_ holds a bit per raw sensor");
+
+  if (this->raw_sensor_count_ >= RAW_SENSORS_MAX) {
+    ESP_LOGE(TAG, "Too many raw sensors, ignoring key 0x%02X", key);
+    return;
+  }
+
+  this->raw_sensors_[this->raw_sensor_count_++] = {sensor, scale, NAN, key, offset, type};
+}
+
+void PanasonicACWLAN::update_raw_sensors(uint8_t key, const uint8_t *value, size_t length) {
+  for (size_t i = 0; i < this->raw_sensor_count_; i++) {
+    RawSensor &raw = this->raw_sensors_[i];
+    int32_t reading;
+
+    if (raw.key != key || !read_raw(raw.type, value, length, raw.offset, &reading))
+      continue;
+
+    float state = reading * raw.scale;
+
+    if (state == raw.state) {
+      this->publishes_suppressed_++;
+      continue;
+    }
+
+    raw.state = state;
+    this->raw_dirty_ |= 1 << i;
+  }
+}
+
+void PanasonicACWLAN::publish_raw_sensors() {
+  for (uint16_t bits = this->raw_dirty_; bits != 0; bits &= bits - 1) {
+    RawSensor &raw = this->raw_sensors_[__builtin_ctz(bits)];
+    raw.sensor->publish_state(raw.state);
+    this->publishes_++;
+  }
+
+  this->raw_dirty_ = 0;
+}
+
 /*
  * Packet handling
  */
@@ -429,133 +727,63 @@ void PanasonicACWLAN::handle_packet() {
   {
     ESP_LOGD(TAG, "Received query response");
 
-    if (this->rx_buffer_.size() != 125) {
-      ESP_LOGW(TAG, "Received invalid query response");
-      return;
+    if (this->state_ == ACState::HandshakeEnding)  // Answer for the first poll
+    {
+      ESP_LOGD(TAG, "Finishing handshake [16/16]");
+      send_command(CMD_HANDSHAKE_16, sizeof(CMD_HANDSHAKE_16));  // State is set to ready in the response
+      this->step_time_ = millis();
+    } else if (this->state_ == ACState::Resuming)  // The AC still knows the session
+    {
+      ESP_LOGD(TAG, "Resumed previous session");
+      set_ready();
     }
 
-    if (this->rx_buffer_[14] == 0x31)          // Check if power state is off
-      this->mode = climate::CLIMATE_MODE_OFF;  // Climate is off
-    else {
-      this->mode = determine_mode(this->rx_buffer_[18]);  // Check mode if power state is not off
+    if (is_unchanged_query()) {
+      ESP_LOGV(TAG, "Query response is unchanged");
+      this->frames_unchanged_++;
+      return;
     }
 
-    update_target_temperature((int8_t) this->rx_buffer_[22]);
-    update_current_temperature((int8_t) this->rx_buffer_[62]);
-    update_outside_temperature((int8_t) this->rx_buffer_[66]);  // Set current (outside) temperature
-
-    std::string horizontalSwing = determine_swing_horizontal(this->rx_buffer_[34]);
-    std::string verticalSwing = determine_swing_vertical(this->rx_buffer_[38]);
-
-    update_swing_horizontal(horizontalSwing);
-    update_swing_vertical(verticalSwing);
-
-    bool nanoex = determine_nanoex(this->rx_buffer_[50]);
-
-    update_nanoex(nanoex);
+    if (update_registers())
+      this->last_query_.assign(this->rx_buffer_.begin(), this->rx_buffer_.end());
+    else
+      ESP_LOGW(TAG, "Query response is cut off, using the entries before the cut");
 
-    this->fan_mode = determine_fan_mode(this->rx_buffer_[26]);
-    this->custom_preset = determine_preset(this->rx_buffer_[42]);
+    apply_registers();
 
-    this->swing_mode = determine_swing(this->rx_buffer_[30]);
+    if (!this->intents_.any_pending())
+      this->command_settled();
 
     // climate::ClimateAction action = determine_action(); // Determine the current action of the AC
     // this->action = action;
 
-    this->publish_state();
+    this->schedule_publish();
   } else if (this->rx_buffer_[2] == 0x10 && this->rx_buffer_[3] == 0x88)  // Command ack
   {
     ESP_LOGV(TAG, "Received command ack");
+    this->command_acknowledged();
   } else if (this->rx_buffer_[2] == 0x10 && this->rx_buffer_[3] == 0x0A)  // Report
   {
     ESP_LOGV(TAG, "Received report");
     send_command(CMD_REPORT_ACK, sizeof(CMD_REPORT_ACK), CommandType::Response);
 
-    if (this->rx_buffer_.size() < 13) {
-      ESP_LOGE(TAG, "Report is too short to handle");
-      return;
-    }
+    this->last_query_.clear();  // The report changed the state, the next query response has to be handled in full
 
-    // 0 = Header & packet type
-    // 1 = Packet length
-    // 2 = Key value pair counter
-    for (int i = 0; i < this->rx_buffer_[10]; i++) {
-      // Offset everything by header, packet length and pair counter (4 * 3)
-      // then offset by pair length (i * 4)
-      int currentIndex = (4 * 3) + (i * 4);
-
-      // 0 = Header
-      // 1 = Data
-      // 2 = Data
-      // 3 = ?
-      switch (this->rx_buffer_[currentIndex]) {
-        case 0x80:  // Power mode
-          switch (this->rx_buffer_[currentIndex + 2]) {
-            case 0x30:  // Power mode on
-              ESP_LOGV(TAG, "Received power mode on");
-              // Ignore power on and let mode be set by other report
-              break;
-            case 0x31:  // Power mode off
-              ESP_LOGV(TAG, "Received power mode off");
-              this->mode = climate::CLIMATE_MODE_OFF;
-              break;
-            default:
-              ESP_LOGW(TAG, "Received unknown power mode");
-              break;
-          }
-          break;
-        case 0xB0:  // Mode
-          this->mode = determine_mode(this->rx_buffer_[currentIndex + 2]);
-          break;
-        case 0x31:  // Target temperature
-          ESP_LOGV(TAG, "Received target temperature");
-          update_target_temperature((int8_t) this->rx_buffer_[currentIndex + 2]);
-          break;
-        case 0xA0:  // Fan mode
-          ESP_LOGV(TAG, "Received fan mode");
-          this->fan_mode = determine_fan_mode(this->rx_buffer_[currentIndex + 2]);
-          break;
-        case 0xB2: // Preset
-          ESP_LOGV(TAG, "Received preset");
-          this->custom_preset = determine_preset(this->rx_buffer_[currentIndex + 2]);
-          break;
-        case 0xA1:
-          ESP_LOGV(TAG, "Received swing mode");
-          this->swing_mode = determine_swing(this->rx_buffer_[currentIndex + 2]);
-          break;
-        case 0xA5:  // Horizontal swing position
-          ESP_LOGV(TAG, "Received horizontal swing position");
+    if (!update_registers())
+      ESP_LOGW(TAG, "Report is cut off, using the entries before the cut");
 
-          update_swing_horizontal(determine_swing_horizontal(this->rx_buffer_[currentIndex + 2]));
-          break;
-        case 0xA4:  // Vertical swing position
-          ESP_LOGV(TAG, "Received vertical swing position");
-
-          update_swing_vertical(determine_swing_vertical(this->rx_buffer_[currentIndex + 2]));
-          break;
-        case 0x33:  // nanoex mode
-          ESP_LOGV(TAG, "Received nanoex state");
-
-          update_nanoex(determine_nanoex(this->rx_buffer_[currentIndex + 2]));
-          break;
-        case 0x20:
-          ESP_LOGV(TAG, "Received unknown nanoex field");
-          // Not sure what this one, ignore it for now
-          break;
-        default:
-          ESP_LOGW(TAG, "Report has unknown field");
-          break;
-      }
-    }
+    apply_registers();
 
     climate::ClimateAction action = determine_action();  // Determine the current action of the AC
     this->action = action;
 
-    this->publish_state();
+    if (!this->intents_.any_pending())
+      this->command_settled();
+
+    this->schedule_publish();
   } else if (this->rx_buffer_[2] == 0x01 && this->rx_buffer_[3] == 0x80)  // Answer for handshake 16
   {
-    ESP_LOGI(TAG, "Panasonic AC component v%s initialized", VERSION);
-    this->state_ = ACState::Ready;
+    set_ready();
   } else {
     ESP_LOGW(TAG, "Received unknown packet");
   }
@@ -631,39 +859,62 @@ void PanasonicACWLAN::handle_handshake_packet() {
  */
 
 void PanasonicACWLAN::send_set_command() {
+  this->last_query_.clear();  // The state was changed optimistically, the next query response has to be handled in full
+  this->command_queued();
+
   // Size of packet is 3 * 4 (for the header, packet size, and key value pair counter)
   // setQueueIndex * 4 for the individual key value pairs
-  int packetLength = (3 * 4) + (this->set_queue_index_ * 4);
+  int packetLength = KeyValueWriter::SIZE + (this->set_queue_index_ * PairWriter::SIZE);
   std::vector<uint8_t> packet(packetLength);
 
-  // Mark this packet as a set command
-  packet[2] = 0x10;
-  packet[3] = 0x08;
+  KeyValueWriter command;
+  KeyValueWriter::wrap(packet.data(), packet.size(), &command);
+
+  command.set_packet_type(0x1008);  // Mark this packet as a set command
+  command.set_payload_length((4 * this->set_queue_index_) - 1 + 6);  // Key value pairs * 4, subtract checksum (-1),
+                                                                     // add 4 for pair counter and 2 for the rest
+  command.set_direction(0x01);
+  command.set_marker(0x01);
+  command.set_pair_header(0x3001);
+  command.set_pair_count(this->set_queue_index_);
 
-  packet[4] = 0x00;                                  // Packet size header
-  packet[5] = (4 * this->set_queue_index_) - 1 + 6;  // Packet size, key value pairs * 4, subtract checksum (-1), add 4
-                                                     // for key value pair counter and 2 for rest of packet size
-  packet[6] = 0x01;
-  packet[7] = 0x01;
+  for (int i = 0; i < this->set_queue_index_; i++) {
+    PairWriter pair;
+    if (!command.pairs_at(i, &pair))
+      break;  // The packet is sized for the queue, so this only happens if they get out of step
+
+    pair.set_key(this->set_queue_[i][0]);
+    pair.set_marker(0x01);
+    pair.set_value(this->set_queue_[i][1]);
+    pair.set_extra(0x00);  // Overwritten by the checksum on the last pair
+  }
 
-  packet[8] = 0x30;  // Key value pair counter header
-  packet[9] = 0x01;
-  packet[10] = this->set_queue_index_;  // Key value pair counter
-  packet[11] = 0x00;
+  if (!send_packet(packet, CommandType::Normal)) {
+    this->command_dropped();
+    return;  // The set queue is kept and sent again once the transmit queue has room
+  }
 
+  // The AC doesn't report values that don't change, so the requested values are applied right away and kept until the
+  // AC reports them
   for (int i = 0; i < this->set_queue_index_; i++) {
-    packet[12 + (i * 4) + 0] = this->set_queue_[i][0];  // Key
-    packet[12 + (i * 4) + 1] = 0x01;                    // Unknown, always 0x01
-    packet[12 + (i * 4) + 2] = this->set_queue_[i][1];  // Value
-    packet[12 + (i * 4) + 3] =
-        0x00;  // Unknown, either 0x00 or 0x01 or 0x02; overwritten by checksum on last key value pair
+    uint8_t key = this->set_queue_[i][0];
+    uint8_t value = this->set_queue_[i][1];
+
+    int field = intent_field(key);
+    if (field >= 0)
+      this->intents_.request(field, value, millis());
+
+    apply_value(key, value);
   }
 
-  send_packet(packet, CommandType::Normal);
+  this->action = determine_action();
+  this->schedule_publish();
+
   this->set_queue_index_ = 0;
 }
 
-void PanasonicACWLAN::send_command(const uint8_t *command, size_t commandLength, CommandType type) {
+bool PanasonicACWLAN::send_command(const uint8_t *command, size_t commandLength, CommandType type,
+                                   TxPriority priority) {
   std::vector<uint8_t> packet(commandLength + 3);  // Reserve space for upcoming packet
 
   for (int i = 0; i < commandLength; i++)  // Loop through command
@@ -671,68 +922,82 @@ void PanasonicACWLAN::send_command(const uint8_t *command, size_t commandLength,
     packet[i + 2] = command[i];  // Add to packet
   }
 
-  this->last_command_ = command;               // Store the last command we sent
-  this->last_command_length_ = commandLength;  // Store the length of the last command we sent
-
-  send_packet(packet, type);  // Actually send the constructed packet
+  return send_packet(packet, type, priority);  // Actually send the constructed packet
 }
 
-void PanasonicACWLAN::send_packet(std::vector<uint8_t> packet, CommandType type) {
-  uint8_t length = packet.size();
-
-  uint8_t checksum = 0;  // Checksum is calculated by adding all bytes together
-  packet[0] = HEADER;    // Write header to packet
+bool PanasonicACWLAN::send_packet(std::vector<uint8_t> packet, CommandType type, TxPriority priority) {
+  packet[0] = HEADER;  // Write header to packet
 
-  uint8_t packetCount = this->transmit_packet_count_;  // Set packet counter
+  if (type == CommandType::Response) {
+    // Responses repeat the counter of the packet they answer, so they are finished right away
+    finish_packet(packet.data(), packet.size(), this->receive_packet_count_);
 
-  if (type == CommandType::Response)
-    packetCount = this->receive_packet_count_;  // Set the packet counter to the rx counter
-  else if (type == CommandType::Resend)
-    packetCount = this->transmit_packet_count_ -
-                  1;  // Set the packet counter to the tx counter -1 (we are sending the same packet again)
-
-  packet[1] = packetCount;  // Write to packet
+    if (this->receive_packet_count_ == 0xFE)
+      this->receive_packet_count_ = 0x01;  // Special case, roll over receive counter after 0xFE
+    else
+      this->receive_packet_count_++;  // Increase rx counter if this was a response
 
-  for (uint8_t i : packet)  // Loop through payload to calculate checksum
-  {
-    checksum += i;  // Add byte to checksum
+    priority = TxPriority::Response;
   }
 
-  checksum = (~checksum + 1);     // Compute checksum
-  packet[length - 1] = checksum;  // Add checksum to end of packet
+  return queue_frame(packet.data(), packet.size(), type, priority);
+}
 
-  this->last_packet_sent_ = millis();  // Save the time when we sent the last packet
+void PanasonicACWLAN::prepare_frame(uint8_t *data, size_t length, CommandType type) {
+  if (type == CommandType::Response)
+    return;  // Don't wait for a response for responses
+
+  if (type == CommandType::Normal) {
+    // The tx counter is set when the packet is written, so it counts up in the order the AC receives the packets
+    finish_packet(data, length, this->transmit_packet_count_);
 
-  if (type == CommandType::Normal)  // Do not increase tx counter if this was a response or if this was a resent packet
-  {
     if (this->transmit_packet_count_ == 0xFE)
       this->transmit_packet_count_ = 0x01;  // Special case, roll over transmit counter after 0xFE
     else
       this->transmit_packet_count_++;  // Increase tx packet counter if this wasn't a response
-  } else if (type == CommandType::Response) {
-    if (this->receive_packet_count_ == 0xFE)
-      this->receive_packet_count_ = 0x01;  // Special case, roll over receive counter after 0xFE
-    else
-      this->receive_packet_count_++;  // Increase rx counter if this was a response
-  }
 
-  if (type != CommandType::Response)     // Don't wait for a response for responses
-    this->waiting_for_response_ = true;  // Mark that we are waiting for a response
+    this->last_frame_.assign(data, data + length);  // Keep the frame as sent, a resend repeats it with the same counter
+    this->resend_attempts_ = 0;
 
-  write_array(packet);       // Write to UART
-  log_packet(packet, true);  // Write to log
+    if (data[2] == 0x10 && data[3] == 0x08)  // Set command
+      this->command_transmitted();
+  }
+
+  this->waiting_for_response_ = true;  // Mark that we are waiting for a response
 }
 
 /*
  * Helpers
  */
 void PanasonicACWLAN::handle_resend() {
-  if (this->waiting_for_response_ && millis() - this->last_packet_sent_ > RESPONSE_TIMEOUT &&
-      this->rx_buffer_.empty())  // Check if AC failed to respond in time and resend packet, if nothing was received yet
-  {
-    ESP_LOGD(TAG, "Resending previous packet");
-    send_command(this->last_command_, this->last_command_length_, CommandType::Resend);
+  if (!this->waiting_for_response_ || !this->rx_ring_.empty() || !this->rx_buffer_.empty())
+    return;  // Nothing to resend or something was received that may still turn out to be the response
+
+  if (!this->tx_queue_.empty())
+    return;  // Whatever is queued goes first, the timeout counts from the last packet written
+
+  // Once ready the timeout doubles with every resend so a lossy link isn't flooded, the handshake keeps resending at
+  // the base timeout since it is bounded by INIT_FAIL_TIMEOUT already
+  bool ready = this->state_ == ACState::Ready;
+  uint32_t timeout = RESPONSE_TIMEOUT;
+  if (ready)
+    timeout = std::min(RESPONSE_TIMEOUT << this->resend_attempts_, RESEND_TIMEOUT_MAX);
+
+  if (millis() - this->last_packet_sent_ <= timeout)
+    return;
+
+  if (ready && this->resend_attempts_ >= RESEND_MAX_ATTEMPTS) {
+    ESP_LOGW(TAG, "No response after %d resends, giving up on previous packet", RESEND_MAX_ATTEMPTS);
+    this->resend_give_ups_++;
+    this->waiting_for_response_ = false;
+    return;
   }
+
+  ESP_LOGD(TAG, "Resending previous packet");
+  this->resend_attempts_++;
+  this->link_error(LINK_RESENDS);
+
+  queue_frame(this->last_frame_.data(), this->last_frame_.size(), CommandType::Resend, TxPriority::Command);
 }
 
 void PanasonicACWLAN::set_value(uint8_t key, uint8_t value) {
@@ -747,6 +1012,14 @@ void PanasonicACWLAN::set_value(uint8_t key, uint8_t value) {
   this->set_queue_index_++;
 }
 
+void PanasonicACWLAN::update_custom_preset(Preset preset) {
+  const char *label = PRESET.label(preset);
+
+  // Only build the preset string when it changes
+  if (!this->custom_preset.has_value() || *this->custom_preset != label)
+    this->custom_preset = std::string(label);
+}
+
 /*
  * Sensor handling
  */
@@ -755,19 +1028,16 @@ void PanasonicACWLAN::on_vertical_swing_change(const std::string &swing) {
   if (this->state_ != ACState::Ready)
     return;
 
-  ESP_LOGD(TAG, "Setting vertical swing position");
+  VerticalSwing position;
 
-  if (swing == "down")
-    set_value(0xA4, 0x42);
-  else if (swing == "down_center")
-    set_value(0xA4, 0x45);
-  else if (swing == "center")
-    set_value(0xA4, 0x43);
-  else if (swing == "up_center")
-    set_value(0xA4, 0x44);
-  else if (swing == "up")
-    set_value(0xA4, 0x41);
+  if (!VERTICAL_SWING.parse(swing, &position)) {
+    ESP_LOGW(TAG, "Unsupported vertical swing position received");
+    return;
+  }
 
+  ESP_LOGD(TAG, "Setting vertical swing position");
+
+  set_value(KEY_VERTICAL_SWING, VERTICAL_SWING.encode(position));
   send_set_command();
 }
 
@@ -775,19 +1045,16 @@ void PanasonicACWLAN::on_horizontal_swing_change(const std::string &swing) {
   if (this->state_ != ACState::Ready)
     return;
 
-  ESP_LOGD(TAG, "Setting horizontal swing position");
+  HorizontalSwing position;
+
+  if (!HORIZONTAL_SWING.parse(swing, &position)) {
+    ESP_LOGW(TAG, "Unsupported horizontal swing position received");
+    return;
+  }
 
-  if (swing == "left")
-    set_value(0xA5, 0x42);
-  else if (swing == "left_center")
-    set_value(0xA5, 0x5C);
-  else if (swing == "center")
-    set_value(0xA5, 0x43);
-  else if (swing == "right_center")
-    set_value(0xA5, 0x56);
-  else if (swing == "right")
-    set_value(0xA5, 0x41);
+  ESP_LOGD(TAG, "Setting horizontal swing position");
 
+  set_value(KEY_HORIZONTAL_SWING, HORIZONTAL_SWING.encode(position));
   send_set_command();
 }
 
@@ -797,10 +1064,10 @@ void PanasonicACWLAN::on_nanoex_change(bool state) {
 
   if (state) {
     ESP_LOGV(TAG, "Turning nanoex on");
-    set_value(0x33, 0x45);  // nanoeX on
+    set_value(KEY_NANOEX, 0x45);  // nanoeX on
   } else {
     ESP_LOGV(TAG, "Turning nanoex off");
-    set_value(0x33, 0x42);  // nanoeX off
+    set_value(KEY_NANOEX, 0x42);  // nanoeX off
   }
 
   send_set_command();
@@ -1,25 +1,59 @@
 #include "esphome/components/climate/climate.h"
 #include "esphome/components/climate/climate_mode.h"
+#include "esphome/core/preferences.h"
 #include "esppac.h"
+#include "esppac_intent.h"
+#include "esppac_registers.h"
+#include "esppac_schema.h"
 
 namespace esphome {
 namespace panasonic_ac {
 namespace WLAN {
 
-static const uint8_t HEADER = 0x5A;  // The header of the protocol, every packet starts with this
+static const uint8_t HEADER = 0x5A;       // The header of the protocol, every packet starts with this
+static const uint8_t SYNC_HEADER = 0x66;  // The header of sync packets, their length is not known
 
-static const int INIT_TIMEOUT = 10000;       // Time to wait before initializing after boot
-static const int INIT_END_TIMEOUT = 10000;   // Time to wait for last handshake packet
-static const int FIRST_POLL_TIMEOUT = 650;   // Time to wait before requesting the first poll
+static const int INIT_DELAY = 500;           // Time to wait after boot before starting, lets the UART settle
+static const int STEP_TIMEOUT = 4000;        // Time a handshake step may go unanswered before it starts over
+static const int RESUME_TIMEOUT = 1500;      // Time to wait for the AC to answer the poll of a resumed session
+static const int FIRST_POLL_DELAY = 650;     // Time to wait after the last handshake answer before the first poll
 static const int POLL_INTERVAL = 30000;      // The interval at which to poll the AC
 static const int RESPONSE_TIMEOUT = 600;     // The timeout after which we expect a response to our last command
+static const int RESEND_TIMEOUT_MAX = 5000;  // The cap for the response timeout, which doubles with every resend
+static const int RESEND_MAX_ATTEMPTS = 5;    // The number of resends after which the last command is given up
 static const int INIT_FAIL_TIMEOUT = 30000;  // The timeout after which the initialization is considered failed
+static const int INTENT_TIMEOUT = 20000;     // Time after which reports replace a requested value, covers all resends
+static const uint32_t TX_FRAME_GAP = 3000;   // Minimum gap (us) between two frames, mimics the real wifi adapter
+static const uint32_t SESSION_WRITE_INTERVAL = 600000;  // Minimum time between two writes of the session to flash
+
+// Keys whose requested values are kept until the AC reports them, the index is the field in the intent table
+static const uint8_t INTENT_KEYS[] = {KEY_POWER, KEY_MODE, KEY_TARGET_TEMPERATURE, KEY_FAN_SPEED,
+                                      KEY_SWING, KEY_HORIZONTAL_SWING, KEY_VERTICAL_SWING, KEY_PRESET, KEY_NANOEX};
+
+static const size_t RAW_SENSORS_MAX = 16;  // Raw register sensors that can be declared in YAML
+
+// Sensor publishing the value of a key as the AC sends it, scaled, declared in YAML
+struct RawSensor {
+  sensor::Sensor *sensor;
+  float scale;
+  float state;     // Value waiting to be published, or the last one published
+  uint8_t key;
+  uint8_t offset;  // Byte of the value to read from, for keys with longer values
+  RawType type;
+};
+
+// Packet counters of an established session, kept in preferences so a restarted module can resume it
+struct SessionState {
+  uint8_t transmit_packet_count;
+  uint8_t receive_packet_count;
+};
 
 enum class ACState {
   Initializing,     // Before first handshake packet is sent
+  Resuming,         // Polling the AC with the counters of the session from before the restart
   Handshake,        // During the initial handshake
-  FirstPoll,        // After the handshake, before polling for the first time
-  HandshakeEnding,  // After the first poll, waiting for the last handshake packet
+  FirstPoll,        // After the handshake, polls for the first time once the last answer is written
+  HandshakeEnding,  // After the first poll, sends the last handshake packet once it is answered
   Ready,            // All done, ready to receive regular packets
   Failed            // Initialization failed
 };
@@ -37,41 +71,86 @@ class PanasonicACWLAN : public PanasonicAC {
 
   void setup() override;
   void loop() override;
+  void on_safe_shutdown() override;
+
+  void add_raw_sensor(uint8_t key, RawType type, float scale, uint8_t offset, sensor::Sensor *sensor);
+
+  uint32_t get_frames_resent() const { return this->link_.total(LINK_RESENDS); }
+  uint32_t get_resend_give_ups() const { return this->resend_give_ups_; }
+  uint32_t get_session_writes() const { return this->session_writes_; }
+  uint32_t get_intents_confirmed() const { return this->intents_.get_confirmed(); }
+  uint32_t get_intents_timed_out() const { return this->intents_.get_timed_out(); }
+  const RegisterFile &get_registers() const { return this->registers_; }
 
  protected:
   ACState state_ = ACState::Initializing;  // Stores the internal state of the AC, used during initialization
+  uint32_t step_time_ = 0;                 // Time at which the current handshake step started
+
+  ESPPreferenceObject session_pref_;  // Counters of the last established session
+  bool has_session_ = false;          // Whether session_pref_ held a session at boot
+  SessionState saved_session_{};      // Counters as last written to session_pref_
+  uint32_t session_written_ = 0;      // Time of the last write to session_pref_
+  uint32_t session_writes_ = 0;       // Number of writes to session_pref_ since boot
 
   uint8_t transmit_packet_count_ = 0;  // Counter used in packet (2nd byte) when we are sending packets
   uint8_t receive_packet_count_ = 0;   // Counter used in packet (2nd byte) when AC is sending us packets
 
-  const uint8_t *last_command_;  // Stores a pointer to the last command we executed
-  size_t last_command_length_;   // Stores the length of the last command we executed
+  std::vector<uint8_t> last_frame_;  // Stores the last frame we sent that expects a response, as it was sent
+  uint8_t resend_attempts_ = 0;      // Number of times last_frame_ has been resent
+
+  uint32_t resend_give_ups_ = 0;  // Number of frames given up after RESEND_MAX_ATTEMPTS resends
+
+  std::vector<uint8_t> last_query_;  // The last query response handled, empty if the state changed since
+  RegisterFile registers_;           // Last values reported or answered by the AC, handlers apply the changed ones
+
+  RawSensor raw_sensors_[RAW_SENSORS_MAX];  // Raw register sensors, in the order they were declared
+  uint8_t raw_sensor_count_ = 0;
+  uint16_t raw_dirty_ = 0;  // Bits of the raw sensors that changed since the last publish
+  IntentTable<sizeof(INTENT_KEYS)> intents_{INTENT_TIMEOUT};  // Values sent to the AC but not reported yet
 
   uint8_t set_queue_[16][2];     // Queue to store the key/value for the set commands
   uint8_t set_queue_index_ = 0;  // Stores the index of the next key/value set
 
   void handle_init_packets();
   void handle_handshake_packet();
+  void start_handshake();
+  void set_ready();
+  void handle_session(bool force);
 
   void handle_poll();
+  bool is_unchanged_query();
+  bool update_registers();
+  void apply_registers();
+  void update_raw_sensors(uint8_t key, const uint8_t *value, size_t length);
+  void publish_raw_sensors();
+
+  bool is_packet_header(uint8_t byte) override;
+  size_t packet_length() override;
+
   bool verify_packet();
   void handle_packet();
 
   void send_set_command();
-  void send_command(const uint8_t *command, size_t commandLength, CommandType type = CommandType::Normal);
-  void send_packet(std::vector<uint8_t> packet, CommandType type = CommandType::Normal);
+  bool send_command(const uint8_t *command, size_t commandLength, CommandType type = CommandType::Normal,
+                    TxPriority priority = TxPriority::Command);
+  bool send_packet(std::vector<uint8_t> packet, CommandType type = CommandType::Normal,
+                   TxPriority priority = TxPriority::Command);
+  void prepare_frame(uint8_t *data, size_t length, CommandType type) override;
 
   climate::ClimateMode determine_mode(uint8_t mode);
   climate::ClimateFanMode determine_fan_mode(uint8_t fan_mode);
-  std::string determine_preset(uint8_t preset);
-  std::string determine_swing_vertical(uint8_t swing);
-  std::string determine_swing_horizontal(uint8_t swing);
+  Preset determine_preset(uint8_t preset);
+  VerticalSwing determine_swing_vertical(uint8_t swing);
+  HorizontalSwing determine_swing_horizontal(uint8_t swing);
   climate::ClimateSwingMode determine_swing(uint8_t swing);
   bool determine_nanoex(uint8_t nanoex);
 
   void handle_resend();
 
   void set_value(uint8_t key, uint8_t value);
+  void apply_value(uint8_t key, uint8_t value);
+  uint8_t reconcile(uint8_t key, uint8_t value);
+  void update_custom_preset(Preset preset);
 };
 
 }  // namespace WLAN
@@ -0,0 +1,505 @@
+/*
+ * Microbenchmarks for the code that runs on every frame, reporting time and heap allocations per operation
+ *
+ * Usage: bench [--filter=substring] [--min-time-ms=100] [--format=table|csv] [--log-level=0]
+ *
+ * Compare results between builds of the same machine and build type only; the numbers are meant to track how the
+ * cost of the hot paths changes, not to predict their cost on an ESP.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "cli.h"
+#include "corpus.h"
+#include "esppac_cnt.h"
+#include "esppac_commands_cnt.h"
+#include "esppac_commands_wlan.h"
+#include "esppac_wlan.h"
+#include "host/host_uart.h"
+#include "panasonic_ac_select.h"
+#include "panasonic_ac_switch.h"
+
+using namespace esphome;
+
+/*
+ * Allocation counting
+ */
+
+static std::atomic<uint64_t> allocations{0};
+static std::atomic<uint64_t> allocated_bytes{0};
+
+static void *counted_alloc(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+  void *p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new(size_t size) { return counted_alloc(size); }
+void *operator new[](size_t size) { return counted_alloc(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return counted_alloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Keeps the compiler from optimizing away a result that is never used
+template<typename T> void do_not_optimize(const T &value) { asm volatile("" : : "r,m"(value) : "memory"); }
+
+/*
+ * Harness
+ */
+
+struct Options {
+  std::string filter;
+  uint32_t min_time_ms = 100;
+  std::string format = "table";
+  int log_level = ESPHOME_LOG_LEVEL_NONE;
+};
+
+struct Result {
+  std::string name;
+  double ns_per_op;
+  double allocations_per_op;
+  double bytes_per_op;
+};
+
+Options options;
+std::vector<Result> results;
+
+// Runs fn (which performs ops operations per call) until min_time_ms has passed, five times, and keeps the fastest run
+template<typename F> void run(const std::string &name, size_t ops, F &&fn) {
+  if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+    return;
+
+  using clock = std::chrono::steady_clock;
+
+  // Warm up, and count allocations of a single call
+  fn();
+  uint64_t allocations_before = allocations.load();
+  uint64_t bytes_before = allocated_bytes.load();
+  fn();
+  double allocations_per_op = double(allocations.load() - allocations_before) / ops;
+  double bytes_per_op = double(allocated_bytes.load() - bytes_before) / ops;
+
+  // Find an iteration count that takes at least a tenth of the minimum time
+  uint64_t iterations = 1;
+  for (;;) {
+    auto start = clock::now();
+    for (uint64_t i = 0; i < iterations; i++)
+      fn();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count();
+    if (elapsed * 10 >= options.min_time_ms || iterations >= (1ULL << 40))
+      break;
+    iterations *= 2;
+  }
+
+  double best = 1e300;
+  for (int round = 0; round < 5; round++) {
+    auto start = clock::now();
+    uint64_t done = 0;
+    do {
+      for (uint64_t i = 0; i < iterations; i++)
+        fn();
+      done += iterations;
+    } while (clock::now() - start < std::chrono::milliseconds(options.min_time_ms / 5 + 1));
+
+    double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    best = std::min(best, ns / (double(done) * ops));
+  }
+
+  results.push_back({name, best, allocations_per_op, bytes_per_op});
+}
+
+void print_results() {
+  if (options.format == "csv") {
+    std::printf("name,ns_per_op,allocations_per_op,bytes_per_op\n");
+    for (const auto &result : results)
+      std::printf("%s,%.2f,%.2f,%.1f\n", result.name.c_str(), result.ns_per_op, result.allocations_per_op,
+                  result.bytes_per_op);
+    return;
+  }
+
+  std::printf("%-44s %12s %12s %12s\n", "benchmark", "ns/op", "allocs/op", "bytes/op");
+  for (const auto &result : results)
+    std::printf("%-44s %12.1f %12.2f %12.1f\n", result.name.c_str(), result.ns_per_op, result.allocations_per_op,
+                result.bytes_per_op);
+}
+
+/*
+ * Components with their per-frame entry points exposed
+ */
+
+// Everything the component publishes to, so the publishing paths are exercised as on a configured device
+struct Entities {
+  sensor::Sensor outside_temperature;
+  sensor::Sensor inside_temperature;
+  sensor::Sensor power_consumption;
+  panasonic_ac::PanasonicACSelect vertical_swing;
+  panasonic_ac::PanasonicACSelect horizontal_swing;
+  panasonic_ac::PanasonicACSwitch nanoex;
+  panasonic_ac::PanasonicACSwitch eco;
+  panasonic_ac::PanasonicACSwitch econavi;
+  panasonic_ac::PanasonicACSwitch mild_dry;
+  host::HostUART uart;
+
+  Entities() {
+    this->vertical_swing.traits.set_options({"swing", "auto", "up", "up_center", "center", "down_center", "down"});
+    this->horizontal_swing.traits.set_options({"swing", "auto", "left", "left_center", "center", "right_center",
+                                               "right"});
+  }
+
+  void attach(panasonic_ac::PanasonicAC *ac) {
+    ac->set_outside_temperature_sensor(&this->outside_temperature);
+    ac->set_inside_temperature_sensor(&this->inside_temperature);
+    ac->set_current_power_consumption_sensor(&this->power_consumption);
+    ac->set_vertical_swing_select(&this->vertical_swing);
+    ac->set_horizontal_swing_select(&this->horizontal_swing);
+    ac->set_nanoex_switch(&this->nanoex);
+    ac->set_eco_switch(&this->eco);
+    ac->set_econavi_switch(&this->econavi);
+    ac->set_mild_dry_switch(&this->mild_dry);
+    ac->set_uart_parent(&this->uart);
+    ac->set_vertical_swing_enable(true);
+    ac->set_horizontal_swing_enable(true);
+  }
+};
+
+class BenchCNT : public panasonic_ac::CNT::PanasonicACCNT {
+ public:
+  using PanasonicACCNT::determine_eco;
+  using PanasonicACCNT::determine_fan_mode;
+  using PanasonicACCNT::determine_horizontal_swing;
+  using PanasonicACCNT::determine_mode;
+  using PanasonicACCNT::determine_power_consumption;
+  using PanasonicACCNT::determine_preset;
+  using PanasonicACCNT::determine_vertical_swing;
+  using PanasonicACCNT::handle_packet;
+  using PanasonicACCNT::publish_pending;
+  using PanasonicACCNT::send_command;
+  using PanasonicACCNT::set_data;
+  using PanasonicACCNT::verify_packet;
+
+  void make_ready() { this->state_ = panasonic_ac::CNT::ACState::Ready; }
+
+  void load(const std::vector<uint8_t> &frame) {
+    this->rx_buffer_.clear();
+    for (uint8_t b : frame)
+      this->rx_buffer_.push_back(b);
+  }
+
+  void load_data(const std::vector<uint8_t> &data) { this->data.assign(data.data(), data.size()); }
+
+  // Makes the next poll response go through the full decode
+  void forget_poll() { this->last_poll_valid_ = false; }
+
+  // Lets the next frame be written right away, as if the line had drained since the last one
+  void free_line() { this->tx_busy_time_ = 0; }
+
+  // Stages a frame as if read from the UART and runs the framer over it
+  bool frame(const std::vector<uint8_t> &frame) {
+    size_t length = frame.size();
+    uint8_t *span = this->rx_ring_.write_span(&length);
+    std::copy(frame.begin(), frame.begin() + length, span);
+    this->rx_ring_.commit(length);
+    return this->read_packet();
+  }
+};
+
+class BenchWLAN : public panasonic_ac::WLAN::PanasonicACWLAN {
+ public:
+  using PanasonicACWLAN::determine_fan_mode;
+  using PanasonicACWLAN::determine_mode;
+  using PanasonicACWLAN::determine_nanoex;
+  using PanasonicACWLAN::determine_preset;
+  using PanasonicACWLAN::determine_swing;
+  using PanasonicACWLAN::determine_swing_horizontal;
+  using PanasonicACWLAN::determine_swing_vertical;
+  using PanasonicACWLAN::handle_packet;
+  using PanasonicACWLAN::send_command;
+  using PanasonicACWLAN::send_set_command;
+  using PanasonicACWLAN::set_value;
+  using PanasonicACWLAN::verify_packet;
+
+  void make_ready() { this->state_ = panasonic_ac::WLAN::ACState::Ready; }
+
+  void load(const std::vector<uint8_t> &frame) {
+    this->rx_buffer_.clear();
+    for (uint8_t b : frame)
+      this->rx_buffer_.push_back(b);
+
+    this->receive_packet_count_ = frame[1];  // Keep the counter check quiet
+    this->waiting_for_response_ = false;
+    this->free_line();                       // Acks are written, not queued
+  }
+
+  // Lets the next frame be written right away, as if the line had drained since the last one
+  void free_line() { this->tx_busy_time_ = 0; }
+
+  // Makes the next query response go through the full decode
+  void forget_query() { this->last_query_.clear(); }
+
+  bool frame(const std::vector<uint8_t> &frame) {
+    size_t length = frame.size();
+    uint8_t *span = this->rx_ring_.write_span(&length);
+    std::copy(frame.begin(), frame.begin() + length, span);
+    this->rx_ring_.commit(length);
+    return this->read_packet();
+  }
+};
+
+void check(bool condition, const char *what) {
+  if (!condition) {
+    std::fprintf(stderr, "Corpus check failed: %s\n", what);
+    std::exit(1);
+  }
+}
+
+/*
+ * CN-CNT
+ */
+
+void bench_cnt() {
+  Entities entities;
+  BenchCNT ac;
+  entities.attach(&ac);
+  ac.setup();
+  ac.make_ready();
+
+  const auto &response = host::cnt_poll_response();
+  ac.load(response);
+  check(ac.verify_packet(), "CN-CNT poll response does not verify");
+
+  static const uint8_t MODES[] = {0x04, 0x34, 0x44, 0x24, 0x64, 0x00};
+  static const uint8_t FAN_MODES[] = {0xA0, 0x30, 0x40, 0x50, 0x60, 0x70};
+  static const uint8_t SWINGS[] = {0xF6, 0xFD, 0x1D, 0x26, 0x3E, 0x49, 0x53, 0x55};
+  static const uint8_t PRESETS[] = {0x40, 0x44, 0x48, 0x00, 0x04};
+
+  run("cnt/frame (poll response)", 1, [&]() { do_not_optimize(ac.frame(response)); });
+
+  run("cnt/verify_packet (poll response)", 1, [&]() {
+    ac.load(response);
+    do_not_optimize(ac.verify_packet());
+  });
+
+  run("cnt/handle_packet (poll response)", 1, [&]() {
+    ac.load(response);
+    ac.forget_poll();
+    ac.handle_packet();
+  });
+
+  run("cnt/handle_packet (unchanged poll response)", 1, [&]() {
+    ac.load(response);
+    ac.handle_packet();
+  });
+
+  run("cnt/handle_packet + publish_pending", 1, [&]() {
+    ac.load(response);
+    ac.forget_poll();
+    ac.handle_packet();
+    ac.publish_pending();
+  });
+
+  run("cnt/set_data", 1, [&]() {
+    ac.load_data(host::cnt_data());
+    ac.set_data(true);
+  });
+
+  run("cnt/determine_mode", sizeof(MODES), [&]() {
+    for (uint8_t v : MODES)
+      do_not_optimize(ac.determine_mode(v >> 4, v & 0x0F));
+  });
+
+  run("cnt/determine_fan_mode", sizeof(FAN_MODES), [&]() {
+    for (uint8_t v : FAN_MODES)
+      do_not_optimize(ac.determine_fan_mode(v, 0x00));
+  });
+
+  run("cnt/determine_vertical_swing", sizeof(SWINGS), [&]() {
+    for (uint8_t v : SWINGS)
+      do_not_optimize(ac.determine_vertical_swing(v >> 4));
+  });
+
+  run("cnt/determine_horizontal_swing", sizeof(SWINGS), [&]() {
+    for (uint8_t v : SWINGS)
+      do_not_optimize(ac.determine_horizontal_swing(v & 0x0F));
+  });
+
+  run("cnt/determine_preset", sizeof(PRESETS), [&]() {
+    for (uint8_t v : PRESETS)
+      do_not_optimize(ac.determine_preset(v, 0x00));
+  });
+
+  run("cnt/determine_eco", sizeof(PRESETS), [&]() {
+    for (uint8_t v : PRESETS)
+      do_not_optimize(ac.determine_eco(v));
+  });
+
+  panasonic_ac::CNT::PollResponse poll;
+  check(panasonic_ac::CNT::PollResponse::wrap(response.data(), response.size(), &poll), "CN-CNT poll response is short");
+
+  run("cnt/determine_power_consumption", 1,
+      [&]() { do_not_optimize(ac.determine_power_consumption(poll.power(), poll.power_offset())); });
+
+  run("cnt/send_command (poll)", 1, [&]() {
+    ac.free_line();
+    ac.send_command(panasonic_ac::CNT::CMD_POLL, sizeof(panasonic_ac::CNT::CMD_POLL), panasonic_ac::CommandType::Normal,
+                    panasonic_ac::CNT::POLL_HEADER);
+  });
+
+  run("cnt/send_command (control)", 1, [&]() {
+    ac.free_line();
+    ac.send_command(host::cnt_data().data(), host::cnt_data().size(), panasonic_ac::CommandType::Normal,
+                    panasonic_ac::CNT::CTRL_HEADER);
+  });
+}
+
+/*
+ * CN-WLAN
+ */
+
+void bench_wlan() {
+  Entities entities;
+  BenchWLAN ac;
+  entities.attach(&ac);
+  ac.setup();
+  ac.make_ready();
+
+  const auto &query = host::wlan_query_response();
+  const auto &report = host::wlan_report();
+  const auto &ping = host::wlan_ping();
+
+  for (const auto *frame : {&query, &report, &ping}) {
+    ac.load(*frame);
+    check(ac.verify_packet(), "CN-WLAN frame does not verify");
+  }
+
+  static const uint8_t MODES[] = {0x41, 0x42, 0x43, 0x44, 0x45};
+  static const uint8_t FAN_MODES[] = {0x41, 0x32, 0x33, 0x34, 0x35, 0x36};
+  static const uint8_t SWINGS[] = {0x41, 0x42, 0x43, 0x44, 0x45};
+  static const uint8_t HORIZONTAL_SWINGS[] = {0x41, 0x42, 0x43, 0x56, 0x5C};
+
+  run("wlan/frame (query response)", 1, [&]() { do_not_optimize(ac.frame(query)); });
+
+  run("wlan/verify_packet (query response)", 1, [&]() {
+    ac.load(query);
+    do_not_optimize(ac.verify_packet());
+  });
+
+  run("wlan/handle_packet (query response)", 1, [&]() {
+    ac.load(query);
+    ac.forget_query();
+    ac.handle_packet();
+  });
+
+  run("wlan/handle_packet (unchanged query response)", 1, [&]() {
+    ac.load(query);
+    ac.handle_packet();
+  });
+
+  run("wlan/handle_packet (report)", 1, [&]() {
+    ac.load(report);
+    ac.handle_packet();
+  });
+
+  run("wlan/handle_packet (ping)", 1, [&]() {
+    ac.load(ping);
+    ac.handle_packet();
+  });
+
+  run("wlan/determine_mode", sizeof(MODES), [&]() {
+    for (uint8_t v : MODES)
+      do_not_optimize(ac.determine_mode(v));
+  });
+
+  run("wlan/determine_fan_mode", sizeof(FAN_MODES), [&]() {
+    for (uint8_t v : FAN_MODES)
+      do_not_optimize(ac.determine_fan_mode(v));
+  });
+
+  run("wlan/determine_preset", 3, [&]() {
+    for (uint8_t v : {0x41, 0x42, 0x43})
+      do_not_optimize(ac.determine_preset(v));
+  });
+
+  run("wlan/determine_swing", sizeof(SWINGS) - 1, [&]() {
+    for (size_t i = 0; i < sizeof(SWINGS) - 1; i++)
+      do_not_optimize(ac.determine_swing(SWINGS[i]));
+  });
+
+  run("wlan/determine_swing_vertical", sizeof(SWINGS), [&]() {
+    for (uint8_t v : SWINGS)
+      do_not_optimize(ac.determine_swing_vertical(v));
+  });
+
+  run("wlan/determine_swing_horizontal", sizeof(HORIZONTAL_SWINGS), [&]() {
+    for (uint8_t v : HORIZONTAL_SWINGS)
+      do_not_optimize(ac.determine_swing_horizontal(v));
+  });
+
+  run("wlan/determine_nanoex", 2, [&]() {
+    do_not_optimize(ac.determine_nanoex(0x42));
+    do_not_optimize(ac.determine_nanoex(0x45));
+  });
+
+  run("wlan/send_command (poll)", 1, [&]() {
+    ac.free_line();
+    ac.send_command(panasonic_ac::WLAN::CMD_POLL, sizeof(panasonic_ac::WLAN::CMD_POLL));
+  });
+
+  run("wlan/send_set_command (mode change)", 1, [&]() {
+    ac.set_value(0xB0, 0x42);
+    ac.set_value(0x80, 0x30);
+    ac.free_line();
+    ac.send_set_command();
+  });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  using host::parse_option;
+
+  std::string value;
+  for (int i = 1; i < argc; i++) {
+    if (parse_option(argv[i], "--filter", &value))
+      options.filter = value;
+    else if (parse_option(argv[i], "--min-time-ms", &value))
+      options.min_time_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--format", &value))
+      options.format = value;
+    else if (parse_option(argv[i], "--log-level", &value))
+      options.log_level = std::atoi(value.c_str());
+    else {
+      std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  host::set_log_level(options.log_level);
+
+  bench_cnt();
+  bench_wlan();
+
+  print_results();
+  return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace host {
+
+// Appends the checksum both protocols use: all bytes of a frame add up to zero
+inline std::vector<uint8_t> with_checksum(std::vector<uint8_t> frame) {
+  uint8_t checksum = 0;
+  for (uint8_t b : frame)
+    checksum -= b;
+
+  frame.push_back(checksum);
+  return frame;
+}
+
+/*
+ * CN-CNT
+ */
+
+// Poll response of a unit cooling to 21.5 degrees, 24 degrees inside and 30 outside, drawing 600 W
+inline const std::vector<uint8_t> &cnt_poll_response() {
+  static const std::vector<uint8_t> FRAME =
+      with_checksum({0x70, 0x20, 0x34, 0x2B, 0x80, 0xA0, 0x36, 0x40, 0x00, 0x40, 0x00, 0x00, 0x3E, 0x2D,
+                     0x00, 0x00, 0x20, 0x85, 0x18, 0x1E, 0xFF, 0x18, 0x1E, 0xFF, 0x80, 0x80, 0xFF, 0x80,
+                     0x68, 0x02, 0x10, 0x00, 0x00, 0x00});
+  return FRAME;
+}
+
+// The 10 byte data block of cnt_poll_response()
+inline const std::vector<uint8_t> &cnt_data() {
+  static const std::vector<uint8_t> DATA(cnt_poll_response().begin() + 2, cnt_poll_response().begin() + 12);
+  return DATA;
+}
+
+/*
+ * CN-WLAN, recorded in protocol/logic_analyzer/controller
+ */
+
+// Answer to CMD_POLL (query_20_15_degress.dsl)
+inline const std::vector<uint8_t> &wlan_query_response() {
+  static const std::vector<uint8_t> FRAME = {
+      0x5A, 0x78, 0x10, 0x89, 0x00, 0x76, 0x00, 0x01, 0x30, 0x01, 0x11, 0x00, 0x80, 0x01, 0x30, 0x00, 0xB0, 0x01,
+      0x42, 0x02, 0x31, 0x01, 0x34, 0x00, 0xA0, 0x01, 0x41, 0x00, 0xA1, 0x01, 0x42, 0x00, 0xA5, 0x01, 0x42, 0x00,
+      0xA4, 0x01, 0x42, 0x00, 0xB2, 0x01, 0x41, 0x02, 0x35, 0x01, 0x41, 0x02, 0x33, 0x01, 0x43, 0x02, 0x34, 0x01,
+      0x41, 0x02, 0x32, 0x01, 0x41, 0x00, 0xBB, 0x01, 0x14, 0x00, 0xBE, 0x01, 0x0F, 0x02, 0x20, 0x01, 0x43, 0x02,
+      0x21, 0x01, 0x41, 0x00, 0x86, 0x2E, 0x2A, 0x00, 0x00, 0x0B, 0x01, 0x01, 0x48, 0x30, 0x30, 0x30, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3B};
+  return FRAME;
+}
+
+// Report of a fan speed change made with the remote (fan_speed_1-5_auto.dsl)
+inline const std::vector<uint8_t> &wlan_report() {
+  static const std::vector<uint8_t> FRAME = {0x5A, 0x36, 0x10, 0x0A, 0x00, 0x09, 0x00, 0x01,
+                                             0x30, 0x01, 0x01, 0x00, 0xA0, 0x01, 0x32, 0x47};
+  return FRAME;
+}
+
+// Ping sent by the unit every minute (ping.dsl)
+inline const std::vector<uint8_t> &wlan_ping() {
+  static const std::vector<uint8_t> FRAME = {0x5A, 0x67, 0x01, 0x01, 0x00, 0x00, 0x3D};
+  return FRAME;
+}
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esphome/components/climate/climate_mode.h"
+#include "esphome/components/climate/climate_traits.h"
+#include "esphome/core/component.h"
+#include "esphome/core/log.h"
+#include "esphome/core/optional.h"
+
+namespace esphome {
+namespace climate {
+
+class Climate;
+
+class ClimateCall {
+ public:
+  explicit ClimateCall(Climate *parent) : parent_(parent) {}
+
+  ClimateCall &set_mode(ClimateMode mode) {
+    this->mode_ = mode;
+    return *this;
+  }
+  ClimateCall &set_target_temperature(float target_temperature) {
+    this->target_temperature_ = target_temperature;
+    return *this;
+  }
+  ClimateCall &set_fan_mode(ClimateFanMode fan_mode) {
+    this->fan_mode_ = fan_mode;
+    return *this;
+  }
+  ClimateCall &set_swing_mode(ClimateSwingMode swing_mode) {
+    this->swing_mode_ = swing_mode;
+    return *this;
+  }
+  ClimateCall &set_preset(ClimatePreset preset) {
+    this->preset_ = preset;
+    return *this;
+  }
+  ClimateCall &set_preset(const std::string &preset) {
+    this->custom_preset_ = preset;
+    return *this;
+  }
+
+  void perform();
+
+  const optional<ClimateMode> &get_mode() const { return this->mode_; }
+  const optional<float> &get_target_temperature() const { return this->target_temperature_; }
+  const optional<ClimateFanMode> &get_fan_mode() const { return this->fan_mode_; }
+  const optional<ClimateSwingMode> &get_swing_mode() const { return this->swing_mode_; }
+  const optional<ClimatePreset> &get_preset() const { return this->preset_; }
+  const optional<std::string> &get_custom_preset() const { return this->custom_preset_; }
+  const optional<std::string> &get_custom_fan_mode() const { return this->custom_fan_mode_; }
+
+ protected:
+  Climate *const parent_;
+  optional<ClimateMode> mode_;
+  optional<float> target_temperature_;
+  optional<ClimateFanMode> fan_mode_;
+  optional<ClimateSwingMode> swing_mode_;
+  optional<ClimatePreset> preset_;
+  optional<std::string> custom_preset_;
+  optional<std::string> custom_fan_mode_;
+};
+
+class Climate : public EntityBase {
+ public:
+  ClimateCall make_call() { return ClimateCall(this); }
+
+  void publish_state();
+  void add_on_state_callback(std::function<void(Climate &)> &&callback) {
+    this->state_callbacks_.push_back(std::move(callback));
+  }
+
+  ClimateTraits get_traits() { return this->traits(); }
+
+  ClimateMode mode{CLIMATE_MODE_OFF};
+  ClimateAction action{CLIMATE_ACTION_OFF};
+  float current_temperature{NAN};
+  float target_temperature{NAN};
+  optional<ClimateFanMode> fan_mode;
+  ClimateSwingMode swing_mode{CLIMATE_SWING_OFF};
+  optional<std::string> custom_fan_mode;
+  optional<ClimatePreset> preset;
+  optional<std::string> custom_preset;
+
+  // Number of times publish_state() was called, used by host tooling
+  uint32_t publish_count{0};
+
+ protected:
+  friend ClimateCall;
+
+  virtual void control(const ClimateCall &call) = 0;
+  virtual ClimateTraits traits() = 0;
+
+  std::vector<std::function<void(Climate &)>> state_callbacks_;
+};
+
+}  // namespace climate
+}  // namespace esphome
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "esphome/components/climate/climate_mode.h"
+
+namespace esphome {
+namespace climate {
+
+class ClimateTraits {
+ public:
+  void set_supports_action(bool supports_action) { this->supports_action_ = supports_action; }
+  void set_supports_current_temperature(bool supports) { this->supports_current_temperature_ = supports; }
+  void set_supports_two_point_target_temperature(bool supports) { this->supports_two_point_ = supports; }
+  void set_visual_min_temperature(float temperature) { this->visual_min_temperature_ = temperature; }
+  void set_visual_max_temperature(float temperature) { this->visual_max_temperature_ = temperature; }
+  void set_visual_temperature_step(float step) { this->visual_temperature_step_ = step; }
+  void set_supported_modes(std::set<ClimateMode> modes) { this->supported_modes_ = std::move(modes); }
+  void set_supported_fan_modes(std::set<ClimateFanMode> modes) { this->supported_fan_modes_ = std::move(modes); }
+  void set_supported_swing_modes(std::set<ClimateSwingMode> modes) { this->supported_swing_modes_ = std::move(modes); }
+  void set_supported_presets(std::set<ClimatePreset> presets) { this->supported_presets_ = std::move(presets); }
+  void set_supported_custom_presets(std::set<std::string> presets) {
+    this->supported_custom_presets_ = std::move(presets);
+  }
+
+  bool get_supports_action() const { return this->supports_action_; }
+  bool get_supports_current_temperature() const { return this->supports_current_temperature_; }
+  float get_visual_min_temperature() const { return this->visual_min_temperature_; }
+  float get_visual_max_temperature() const { return this->visual_max_temperature_; }
+  float get_visual_temperature_step() const { return this->visual_temperature_step_; }
+  const std::set<ClimateMode> &get_supported_modes() const { return this->supported_modes_; }
+  const std::set<ClimateFanMode> &get_supported_fan_modes() const { return this->supported_fan_modes_; }
+  const std::set<ClimateSwingMode> &get_supported_swing_modes() const { return this->supported_swing_modes_; }
+  const std::set<ClimatePreset> &get_supported_presets() const { return this->supported_presets_; }
+  const std::set<std::string> &get_supported_custom_presets() const { return this->supported_custom_presets_; }
+
+ protected:
+  bool supports_action_{false};
+  bool supports_current_temperature_{false};
+  bool supports_two_point_{false};
+  float visual_min_temperature_{10};
+  float visual_max_temperature_{30};
+  float visual_temperature_step_{0.1f};
+  std::set<ClimateMode> supported_modes_;
+  std::set<ClimateFanMode> supported_fan_modes_;
+  std::set<ClimateSwingMode> supported_swing_modes_;
+  std::set<ClimatePreset> supported_presets_;
+  std::set<std::string> supported_custom_presets_;
+};
+
+}  // namespace climate
+}  // namespace esphome
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/log.h"
+#include "esphome/core/optional.h"
+
+namespace esphome {
+namespace select {
+
+class Select;
+
+class SelectTraits {
+ public:
+  void set_options(std::vector<std::string> options) { this->options_ = std::move(options); }
+  const std::vector<std::string> &get_options() const { return this->options_; }
+
+ protected:
+  std::vector<std::string> options_;
+};
+
+class SelectCall {
+ public:
+  explicit SelectCall(Select *parent) : parent_(parent) {}
+
+  SelectCall &set_option(const std::string &option) {
+    this->option_ = option;
+    return *this;
+  }
+
+  void perform();
+
+ protected:
+  Select *const parent_;
+  optional<std::string> option_;
+};
+
+class Select : public EntityBase {
+ public:
+  SelectCall make_call() { return SelectCall(this); }
+
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publish_count++;
+    size_t index = this->index_of(state).value_or(0);
+    for (auto &callback : this->state_callbacks_)
+      callback(state, index);
+  }
+
+  void add_on_state_callback(std::function<void(std::string, size_t)> &&callback) {
+    this->state_callbacks_.push_back(std::move(callback));
+  }
+
+  optional<size_t> index_of(const std::string &option) const {
+    const auto &options = this->traits.get_options();
+    for (size_t i = 0; i < options.size(); i++) {
+      if (options[i] == option)
+        return i;
+    }
+    return {};
+  }
+
+  bool has_state() const { return this->has_state_; }
+
+  std::string state;
+  SelectTraits traits;
+
+  // Number of times publish_state() was called, used by host tooling
+  uint32_t publish_count{0};
+
+ protected:
+  friend SelectCall;
+
+  virtual void control(const std::string &value) = 0;
+
+  bool has_state_{false};
+  std::vector<std::function<void(std::string, size_t)>> state_callbacks_;
+};
+
+inline void SelectCall::perform() {
+  if (this->option_.has_value())
+    this->parent_->control(*this->option_);
+}
+
+}  // namespace select
+}  // namespace esphome
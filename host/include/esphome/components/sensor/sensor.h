@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace sensor {
+
+class Sensor : public EntityBase {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publish_count++;
+    for (auto &callback : this->state_callbacks_)
+      callback(state);
+  }
+
+  void add_on_state_callback(std::function<void(float)> &&callback) {
+    this->state_callbacks_.push_back(std::move(callback));
+  }
+
+  bool has_state() const { return this->has_state_; }
+
+  float state{NAN};
+
+  // Number of times publish_state() was called, used by host tooling
+  uint32_t publish_count{0};
+
+ protected:
+  bool has_state_{false};
+  std::vector<std::function<void(float)>> state_callbacks_;
+};
+
+}  // namespace sensor
+}  // namespace esphome
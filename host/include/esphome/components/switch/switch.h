@@ -0,0 +1,42 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace switch_ {
+
+class Switch : public EntityBase {
+ public:
+  void turn_on() { this->write_state(true); }
+  void turn_off() { this->write_state(false); }
+  void toggle() { this->write_state(!this->state); }
+
+  void publish_state(bool state) {
+    this->state = state;
+    this->publish_count++;
+    for (auto &callback : this->state_callbacks_)
+      callback(state);
+  }
+
+  void add_on_state_callback(std::function<void(bool)> &&callback) {
+    this->state_callbacks_.push_back(std::move(callback));
+  }
+
+  bool state{false};
+
+  // Number of times publish_state() was called, used by host tooling
+  uint32_t publish_count{0};
+
+ protected:
+  virtual void write_state(bool state) = 0;
+
+  std::vector<std::function<void(bool)>> state_callbacks_;
+};
+
+}  // namespace switch_
+}  // namespace esphome
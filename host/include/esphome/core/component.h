@@ -0,0 +1,50 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/optional.h"
+
+namespace esphome {
+
+namespace setup_priority {
+
+const float DATA = 600.0f;
+const float HARDWARE = 800.0f;
+const float BUS = 1000.0f;
+
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual void on_safe_shutdown() {}
+  virtual void on_shutdown() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+
+ protected:
+  bool failed_{false};
+};
+
+class EntityBase {
+ public:
+  const std::string &get_name() const { return this->name_; }
+  void set_name(const std::string &name) { this->name_ = name; }
+  // ESPHome hashes the object id, the snake case name, which the host stub does not derive
+  uint32_t get_object_id_hash() const { return fnv1_hash(this->name_); }
+
+ protected:
+  std::string name_;
+};
+
+}  // namespace esphome
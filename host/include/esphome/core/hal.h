@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+namespace host {
+
+// When the virtual clock is enabled time only moves through advance_time() and delay()
+void set_virtual_clock(bool enabled);
+bool is_virtual_clock();
+void advance_time_us(uint64_t us);
+inline void advance_time(uint32_t ms) { advance_time_us(uint64_t(ms) * 1000); }
+uint64_t now_us();
+
+}  // namespace host
+}  // namespace esphome
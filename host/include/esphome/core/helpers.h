@@ -0,0 +1,17 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+std::string format_hex_pretty(const uint8_t *data, size_t length);
+std::string format_hex_pretty(const std::vector<uint8_t> &data);
+
+uint32_t fnv1_hash(const std::string &str);
+
+}  // namespace esphome
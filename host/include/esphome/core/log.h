@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstdint>
+
+#include "esphome/core/helpers.h"
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+
+// Arguments are only evaluated when the runtime level allows the message, mirroring the compiled-out
+// macros on the device closely enough for benchmarks
+#define ESPHOME_HOST_LOG_(level, tag, ...) \
+  do { \
+    if (::esphome::host::log_level() >= (level)) \
+      ::esphome::esp_log_printf_((level), (tag), __LINE__, __VA_ARGS__); \
+  } while (0)
+
+#define ESP_LOGE(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+
+namespace esphome {
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+namespace host {
+
+int log_level();
+void set_log_level(int level);
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include "esphome/components/uart/uart.h"
+
+namespace esphome {
+namespace host {
+
+/*
+ * In-process UART transport: bytes fed by the peer become readable by the device,
+ * bytes written by the device are handed to the peer through a callback
+ */
+class HostUART : public uart::UARTComponent {
+ public:
+  using WriteCallback = std::function<void(const uint8_t *data, size_t len)>;
+
+  void set_write_callback(WriteCallback &&callback) { this->write_callback_ = std::move(callback); }
+
+  // Makes bytes available to the device as if they arrived on the RX pin
+  void feed(const uint8_t *data, size_t len);
+  void feed(uint8_t byte) { this->feed(&byte, 1); }
+
+  // Drops everything not read yet, as a reboot of the device would
+  void clear() { this->rx_.clear(); }
+
+  void write_array(const uint8_t *data, size_t len) override;
+  bool peek_byte(uint8_t *data) override;
+  bool read_array(uint8_t *data, size_t len) override;
+  int available() override { return static_cast<int>(this->rx_.size()); }
+  void flush() override {}
+
+  uint64_t bytes_written() const { return this->bytes_written_; }
+  uint64_t bytes_read() const { return this->bytes_read_; }
+
+ protected:
+  std::deque<uint8_t> rx_;
+  WriteCallback write_callback_;
+  uint64_t bytes_written_{0};
+  uint64_t bytes_read_{0};
+};
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,218 @@
+#include "dsl_reader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+#include <zlib.h>
+
+namespace esphome {
+namespace host {
+
+static const uint32_t ZIP_LOCAL_HEADER = 0x04034B50;
+static const uint32_t ZIP_CENTRAL_HEADER = 0x02014B50;
+static const uint32_t ZIP_END_OF_DIRECTORY = 0x06054B50;
+static const uint16_t ZIP_STORED = 0;
+static const uint16_t ZIP_DEFLATED = 8;
+
+static uint16_t read16(const std::vector<uint8_t> &data, size_t offset) {
+  return data[offset] | (data[offset + 1] << 8);
+}
+
+static uint32_t read32(const std::vector<uint8_t> &data, size_t offset) {
+  return read16(data, offset) | (uint32_t(read16(data, offset + 2)) << 16);
+}
+
+/*
+ * Zip archive
+ */
+
+struct ZipEntry {
+  uint16_t method;
+  uint32_t compressed_size;
+  uint32_t size;
+  uint32_t local_header;
+};
+
+static bool read_directory(const std::vector<uint8_t> &archive, std::map<std::string, ZipEntry> *entries) {
+  if (archive.size() < 22)
+    return false;
+
+  // The end of directory record is followed by a comment of up to 64 kB
+  size_t end = archive.size() - 22;
+  size_t limit = end > 0xFFFF ? end - 0xFFFF : 0;
+  while (read32(archive, end) != ZIP_END_OF_DIRECTORY) {
+    if (end == limit)
+      return false;
+    end--;
+  }
+
+  uint16_t count = read16(archive, end + 10);
+  size_t offset = read32(archive, end + 16);
+
+  for (uint16_t i = 0; i < count; i++) {
+    if (offset + 46 > archive.size() || read32(archive, offset) != ZIP_CENTRAL_HEADER)
+      return false;
+
+    uint16_t name_length = read16(archive, offset + 28);
+    uint16_t extra_length = read16(archive, offset + 30);
+    uint16_t comment_length = read16(archive, offset + 32);
+
+    if (offset + 46 + name_length > archive.size())
+      return false;
+
+    ZipEntry entry;
+    entry.method = read16(archive, offset + 10);
+    entry.compressed_size = read32(archive, offset + 20);
+    entry.size = read32(archive, offset + 24);
+    entry.local_header = read32(archive, offset + 42);
+
+    std::string name(archive.begin() + offset + 46, archive.begin() + offset + 46 + name_length);
+    (*entries)[name] = entry;
+
+    offset += 46 + name_length + extra_length + comment_length;
+  }
+
+  return true;
+}
+
+static bool extract(const std::vector<uint8_t> &archive, const ZipEntry &entry, std::vector<uint8_t> *data) {
+  size_t offset = entry.local_header;
+  if (offset + 30 > archive.size() || read32(archive, offset) != ZIP_LOCAL_HEADER)
+    return false;
+
+  offset += 30 + read16(archive, offset + 26) + read16(archive, offset + 28);
+  if (offset + entry.compressed_size > archive.size())
+    return false;
+
+  data->resize(entry.size);
+
+  if (entry.method == ZIP_STORED) {
+    if (entry.compressed_size != entry.size)
+      return false;
+
+    std::memcpy(data->data(), archive.data() + offset, entry.size);
+    return true;
+  }
+
+  if (entry.method != ZIP_DEFLATED)
+    return false;
+
+  z_stream stream{};
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)  // Raw deflate, zip has its own headers
+    return false;
+
+  stream.next_in = const_cast<Bytef *>(archive.data() + offset);
+  stream.avail_in = entry.compressed_size;
+  stream.next_out = data->data();
+  stream.avail_out = entry.size;
+
+  int result = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+
+  return result == Z_STREAM_END && stream.total_out == entry.size;
+}
+
+/*
+ * Capture
+ */
+
+int Capture::probe_index(const std::string &name) const {
+  for (size_t i = 0; i < this->probes.size(); i++) {
+    if (this->probes[i] == name)
+      return i;
+  }
+
+  return -1;
+}
+
+static double parse_samplerate(const std::string &value) {
+  char *unit = nullptr;
+  double rate = std::strtod(value.c_str(), &unit);
+
+  std::string suffix(unit);
+  if (suffix.find("MHz") != std::string::npos)
+    return rate * 1e6;
+  if (suffix.find("kHz") != std::string::npos)
+    return rate * 1e3;
+
+  return rate;
+}
+
+bool read_dsl(const std::string &path, Capture *capture, std::string *error) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    *error = "cannot open file";
+    return false;
+  }
+
+  std::vector<uint8_t> archive((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  std::map<std::string, ZipEntry> entries;
+  if (!read_directory(archive, &entries)) {
+    *error = "not a zip archive";
+    return false;
+  }
+
+  auto header_entry = entries.find("header");
+  std::vector<uint8_t> header_data;
+  if (header_entry == entries.end() || !extract(archive, header_entry->second, &header_data)) {
+    *error = "missing header";
+    return false;
+  }
+
+  // Header is an ini file, only the [header] section is of interest
+  std::map<std::string, std::string> header;
+  std::istringstream lines(std::string(header_data.begin(), header_data.end()));
+  std::string line;
+  while (std::getline(lines, line)) {
+    size_t separator = line.find(" = ");
+    if (separator != std::string::npos)
+      header[line.substr(0, separator)] = line.substr(separator + 3);
+  }
+
+  capture->samplerate = parse_samplerate(header["samplerate"]);
+  capture->samples = std::strtoull(header["total samples"].c_str(), nullptr, 10);
+  capture->trigger_time_ms = std::strtoull(header["trigger time"].c_str(), nullptr, 10);
+  size_t probes = std::strtoul(header["total probes"].c_str(), nullptr, 10);
+  size_t blocks = std::strtoul(header["total blocks"].c_str(), nullptr, 10);
+
+  if (capture->samplerate <= 0 || capture->samples == 0 || probes == 0) {
+    *error = "invalid header";
+    return false;
+  }
+
+  capture->probes.assign(probes, "");
+  capture->channels.assign(probes, {});
+
+  for (size_t probe = 0; probe < probes; probe++) {
+    capture->probes[probe] = header["probe" + std::to_string(probe)];
+
+    auto &channel = capture->channels[probe];
+    for (size_t block = 0; block < blocks; block++) {
+      std::string name = "L-" + std::to_string(probe) + "/" + std::to_string(block);
+      auto entry = entries.find(name);
+      std::vector<uint8_t> data;
+
+      if (entry == entries.end() || !extract(archive, entry->second, &data)) {
+        *error = "missing or corrupt " + name;
+        return false;
+      }
+
+      channel.insert(channel.end(), data.begin(), data.end());
+    }
+
+    if (channel.size() * 8 < capture->samples) {
+      *error = "probe " + capture->probes[probe] + " is shorter than the capture";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace host {
+
+/*
+ * A DSView logic analyzer capture (.dsl), a zip archive holding a header and one bit-packed sample stream per probe
+ */
+struct Capture {
+  double samplerate = 0;              // Samples per second
+  uint64_t samples = 0;               // Samples per probe
+  uint64_t trigger_time_ms = 0;       // Wall clock time of the trigger, milliseconds since the epoch
+  std::vector<std::string> probes;    // Probe names, indexed by probe number
+  std::vector<std::vector<uint8_t>> channels;  // Samples per probe, least significant bit first
+
+  // Returns the probe number with the given name, or -1
+  int probe_index(const std::string &name) const;
+
+  bool sample(size_t probe, uint64_t index) const {
+    return (this->channels[probe][index >> 3] >> (index & 7)) & 1;
+  }
+
+  double duration_s() const { return this->samplerate == 0 ? 0 : this->samples / this->samplerate; }
+};
+
+// Reads a capture, returns false and sets error if the file could not be read
+bool read_dsl(const std::string &path, Capture *capture, std::string *error);
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,510 @@
+/*
+ * Replays the AC side (RX probe) of DSView captures into PanasonicACWLAN or PanasonicACCNT on the virtual clock and
+ * reports the decoded state timeline and the processing cost per frame
+ *
+ * Usage: replay [--protocol=wlan] [--start=auto] [--speed=0] [--loop-ms=16] [--baud=9600] [--rx-probe=RX]
+ *               [--tx-probe=TX] [--frames] [--timeline-out=file] [--expect=file] [--log-level=2] capture.dsl...
+ *
+ * --start=boot replays from a freshly booted component, --start=ready skips the CN-WLAN handshake for captures taken
+ * mid-session and --start=auto picks ready unless the capture contains a handshake
+ * --speed=0 replays as fast as possible, 1 in real time, 10 at ten times real time
+ * --expect compares the timeline of all captures against a file written by --timeline-out and fails on differences
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cli.h"
+#include "dsl_reader.h"
+#include "esppac_cnt.h"
+#include "esppac_wlan.h"
+#include "host/host_uart.h"
+#include "panasonic_ac_select.h"
+#include "panasonic_ac_switch.h"
+#include "stats.h"
+#include "uart_decoder.h"
+
+using namespace esphome;
+
+namespace {
+
+struct Options {
+  std::string protocol = "wlan";
+  std::string start = "auto";
+  double speed = 0;
+  uint32_t loop_ms = 16;
+  std::string rx_probe = "RX";
+  std::string tx_probe = "TX";
+  bool frames = false;
+  std::string timeline_out;
+  std::string expect;
+  int log_level = ESPHOME_LOG_LEVEL_WARN;
+  host::UARTFormat format;
+  std::vector<std::string> files;
+};
+
+Options parse_options(int argc, char **argv) {
+  using host::parse_option;
+
+  Options options;
+  std::string value;
+
+  for (int i = 1; i < argc; i++) {
+    if (parse_option(argv[i], "--protocol", &value))
+      options.protocol = value;
+    else if (parse_option(argv[i], "--start", &value))
+      options.start = value;
+    else if (parse_option(argv[i], "--speed", &value))
+      options.speed = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--loop-ms", &value))
+      options.loop_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--baud", &value))
+      options.format.baud_rate = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--rx-probe", &value))
+      options.rx_probe = value;
+    else if (parse_option(argv[i], "--tx-probe", &value))
+      options.tx_probe = value;
+    else if (std::string(argv[i]) == "--frames")
+      options.frames = true;
+    else if (parse_option(argv[i], "--timeline-out", &value))
+      options.timeline_out = value;
+    else if (parse_option(argv[i], "--expect", &value))
+      options.expect = value;
+    else if (parse_option(argv[i], "--log-level", &value))
+      options.log_level = std::atoi(value.c_str());
+    else if (argv[i][0] == '-') {
+      std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+      std::exit(2);
+    } else {
+      options.files.push_back(argv[i]);
+    }
+  }
+
+  if (options.protocol != "wlan" && options.protocol != "cnt") {
+    std::fprintf(stderr, "Unknown protocol %s, expected wlan or cnt\n", options.protocol.c_str());
+    std::exit(2);
+  }
+
+  if (options.start != "auto" && options.start != "boot" && options.start != "ready") {
+    std::fprintf(stderr, "Unknown start %s, expected auto, boot or ready\n", options.start.c_str());
+    std::exit(2);
+  }
+
+  if (options.files.empty()) {
+    std::fprintf(stderr, "No captures given\n");
+    std::exit(2);
+  }
+
+  // Replay in a fixed order so timelines can be compared regardless of how the shell expanded the arguments
+  std::sort(options.files.begin(), options.files.end());
+
+  return options;
+}
+
+// Lets a replay start in the middle of a session, after the handshake
+class ReplayWLAN : public panasonic_ac::WLAN::PanasonicACWLAN {
+ public:
+  void skip_handshake() { this->state_ = panasonic_ac::WLAN::ACState::Ready; }
+};
+
+struct Frame {
+  uint64_t start_us;
+  uint64_t end_us;
+  std::vector<uint8_t> bytes;
+};
+
+// Length of the frame starting at bytes[offset] according to the protocol, 0 if it cannot be determined
+size_t frame_length(const std::string &protocol, const std::vector<uint8_t> &bytes, size_t offset) {
+  size_t available = bytes.size() - offset;
+
+  if (protocol == "wlan") {
+    if (bytes[offset] != 0x5A || available < 6)
+      return 0;
+    return ((bytes[offset + 4] << 8) | bytes[offset + 5]) + 7;
+  }
+
+  if ((bytes[offset] != 0xF0 && bytes[offset] != 0x70) || available < 2)
+    return 0;
+  return bytes[offset + 1] + 3;
+}
+
+// Splits the decoded bytes into bursts separated by idle time, then bursts into frames by their length field
+std::vector<Frame> split_frames(const std::string &protocol, const std::vector<host::UARTByte> &decoded,
+                                uint32_t baud_rate) {
+  const uint64_t gap_us = 3 * 11 * 1000000ULL / baud_rate;
+  std::vector<Frame> frames;
+
+  size_t i = 0;
+  while (i < decoded.size()) {
+    size_t end = i + 1;
+    while (end < decoded.size() && decoded[end].start_us - decoded[end - 1].end_us < gap_us)
+      end++;
+
+    std::vector<uint8_t> burst;
+    for (size_t j = i; j < end; j++)
+      burst.push_back(decoded[j].value);
+
+    size_t offset = 0;
+    while (offset < burst.size()) {
+      size_t length = frame_length(protocol, burst, offset);
+      if (length == 0 || offset + length > burst.size())
+        length = burst.size() - offset;
+
+      Frame frame;
+      frame.start_us = decoded[i + offset].start_us;
+      frame.end_us = decoded[i + offset + length - 1].end_us;
+      frame.bytes.assign(burst.begin() + offset, burst.begin() + offset + length);
+      frames.push_back(std::move(frame));
+
+      offset += length;
+    }
+
+    i = end;
+  }
+
+  return frames;
+}
+
+std::string format_bytes(const std::vector<uint8_t> &bytes) {
+  std::string text;
+  char hex[4];
+
+  for (uint8_t b : bytes) {
+    std::snprintf(hex, sizeof(hex), "%02X ", b);
+    text += hex;
+  }
+
+  if (!text.empty())
+    text.pop_back();
+  return text;
+}
+
+std::string format_time(uint64_t us) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%9.3f", us / 1e6);
+  return text;
+}
+
+std::string format_float(float value) {
+  if (std::isnan(value))
+    return "-";
+
+  char text[16];
+  std::snprintf(text, sizeof(text), "%.1f", value);
+  return text;
+}
+
+// Everything the component exposes to ESPHome
+struct Entities {
+  sensor::Sensor outside_temperature;
+  sensor::Sensor inside_temperature;
+  sensor::Sensor current_temperature;
+  sensor::Sensor power_consumption;
+  panasonic_ac::PanasonicACSelect vertical_swing;
+  panasonic_ac::PanasonicACSelect horizontal_swing;
+  panasonic_ac::PanasonicACSwitch nanoex;
+  panasonic_ac::PanasonicACSwitch eco;
+  panasonic_ac::PanasonicACSwitch econavi;
+  panasonic_ac::PanasonicACSwitch mild_dry;
+
+  void attach(panasonic_ac::PanasonicAC *ac) {
+    ac->set_outside_temperature_sensor(&this->outside_temperature);
+    ac->set_inside_temperature_sensor(&this->inside_temperature);
+    ac->set_current_temperature_sensor(&this->current_temperature);
+    ac->set_current_power_consumption_sensor(&this->power_consumption);
+    ac->set_vertical_swing_select(&this->vertical_swing);
+    ac->set_horizontal_swing_select(&this->horizontal_swing);
+    ac->set_nanoex_switch(&this->nanoex);
+    ac->set_eco_switch(&this->eco);
+    ac->set_econavi_switch(&this->econavi);
+    ac->set_mild_dry_switch(&this->mild_dry);
+  }
+};
+
+std::string format_state(const panasonic_ac::PanasonicAC &ac, const Entities &entities) {
+  std::string state = "mode=";
+  state += climate::climate_mode_to_string(ac.mode);
+  state += " target=" + format_float(ac.target_temperature);
+  state += " current=" + format_float(ac.current_temperature);
+  state += " fan=";
+  state += ac.fan_mode.has_value() ? climate::climate_fan_mode_to_string(*ac.fan_mode) : "-";
+  state += " swing=";
+  state += climate::climate_swing_mode_to_string(ac.swing_mode);
+  state += " preset=" + (ac.custom_preset.has_value() ? *ac.custom_preset : std::string("-"));
+  state += " outside=" + format_float(entities.outside_temperature.state);
+  state += " inside=" + format_float(entities.inside_temperature.state);
+  state += " power=" + format_float(entities.power_consumption.state);
+  state += " vswing=" + (entities.vertical_swing.state.empty() ? std::string("-") : entities.vertical_swing.state);
+  state += " hswing=" + (entities.horizontal_swing.state.empty() ? std::string("-") : entities.horizontal_swing.state);
+  state += " nanoex=" + std::string(entities.nanoex.state ? "on" : "off");
+  state += " eco=" + std::string(entities.eco.state ? "on" : "off");
+  state += " econavi=" + std::string(entities.econavi.state ? "on" : "off");
+  state += " mild_dry=" + std::string(entities.mild_dry.state ? "on" : "off");
+  return state;
+}
+
+struct Totals {
+  uint64_t rx_bytes = 0;
+  uint64_t rx_frames = 0;
+  uint64_t parity_errors = 0;
+  uint64_t framing_errors = 0;
+  uint64_t recorded_tx_frames = 0;
+  uint64_t tx_bytes = 0;
+  uint64_t tx_frames = 0;
+  uint64_t publishes = 0;
+  uint64_t entity_publishes = 0;
+  uint64_t publishes_suppressed = 0;
+  uint64_t frames_unchanged = 0;
+  double duration_s = 0;
+  host::Histogram frame_ns;
+  host::Histogram idle_ns;
+};
+
+// Replays one capture, appending its state changes to timeline
+bool replay(const std::string &path, const Options &options, std::vector<std::string> *timeline, Totals *totals) {
+  host::Capture capture;
+  std::string error;
+
+  if (!host::read_dsl(path, &capture, &error)) {
+    std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+    return false;
+  }
+
+  int rx_probe = capture.probe_index(options.rx_probe);
+  int tx_probe = capture.probe_index(options.tx_probe);
+  if (rx_probe < 0) {
+    std::fprintf(stderr, "%s: no probe named %s\n", path.c_str(), options.rx_probe.c_str());
+    return false;
+  }
+
+  auto rx = host::decode_uart(capture, rx_probe, options.format);
+  auto frames = split_frames(options.protocol, rx, options.format.baud_rate);
+
+  uint64_t recorded_tx_frames = 0;
+  if (tx_probe >= 0)
+    recorded_tx_frames =
+        split_frames(options.protocol, host::decode_uart(capture, tx_probe, options.format), options.format.baud_rate)
+            .size();
+
+  for (const auto &byte : rx) {
+    totals->parity_errors += byte.parity_error;
+    totals->framing_errors += byte.framing_error;
+  }
+
+  std::printf("%s: %.0f Hz, %.1f s, %zu RX bytes in %zu frames, %llu recorded TX frames\n", path.c_str(),
+              capture.samplerate, capture.duration_s(), rx.size(), frames.size(),
+              (unsigned long long) recorded_tx_frames);
+
+  timeline->push_back("# " + path);
+
+  host::clear_preferences();  // Every capture was taken from a module without a stored session
+
+  host::HostUART uart;
+  std::unique_ptr<panasonic_ac::PanasonicAC> ac;
+  if (options.protocol == "wlan")
+    ac = std::make_unique<ReplayWLAN>();
+  else
+    ac = std::make_unique<panasonic_ac::CNT::PanasonicACCNT>();
+
+  Entities entities;
+  entities.attach(ac.get());
+  ac->set_uart_parent(&uart);
+
+  uint64_t base_us = host::now_us();
+  auto relative_now = [&]() { return host::now_us() - base_us; };
+
+  // A capture holding the answer to the second handshake packet was taken from boot
+  bool has_handshake = false;
+  for (const auto &frame : frames) {
+    if (frame.bytes.size() > 3 && frame.bytes[0] == 0x5A && frame.bytes[2] == 0x00 && frame.bytes[3] == 0x89)
+      has_handshake = true;
+  }
+
+  bool skip_handshake = options.protocol == "wlan" &&
+                        (options.start == "ready" || (options.start == "auto" && !has_handshake));
+
+  std::string last_state;
+  uint32_t last_publishes = 0;
+  auto record_state = [&]() {
+    std::string state = format_state(*ac, entities);
+    if (state == last_state)
+      return;
+
+    last_state = state;
+    timeline->push_back(format_time(relative_now()) + " " + state);
+    std::printf("  %s\n", timeline->back().c_str());
+  };
+
+  ac->add_on_state_callback([&](climate::Climate &) { totals->publishes++; });
+
+  uart.set_write_callback([&](const uint8_t *data, size_t len) {
+    totals->tx_bytes += len;
+    totals->tx_frames++;
+
+    if (options.frames)
+      std::printf("  %s TX %s\n", format_time(relative_now()).c_str(),
+                  format_bytes(std::vector<uint8_t>(data, data + len)).c_str());
+  });
+
+  ac->setup();
+
+  if (skip_handshake) {
+    static_cast<ReplayWLAN *>(ac.get())->skip_handshake();
+    timeline->push_back(format_time(0) + " ready (handshake skipped)");
+    std::printf("  %s\n", timeline->back().c_str());
+  }
+
+  const uint64_t loop_us = uint64_t(options.loop_ms) * 1000;
+  const uint64_t end_us = static_cast<uint64_t>(capture.duration_s() * 1e6);
+  auto wall_start = std::chrono::steady_clock::now();
+  uint64_t next_loop_us = 0;
+  bool failed = false;
+
+  auto advance_to = [&](uint64_t us) {
+    if (us > relative_now())
+      host::advance_time_us(us - relative_now());
+
+    if (options.speed > 0) {
+      auto due = wall_start + std::chrono::microseconds(static_cast<uint64_t>(us / options.speed));
+      std::this_thread::sleep_until(due);
+    }
+  };
+
+  auto timed_loop = [&](host::Histogram *histogram) {
+    auto start = std::chrono::steady_clock::now();
+    ac->loop();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    histogram->add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+    // Publishes are deferred to the end of loop(), so the entities are consistent once it returns
+    if (ac->get_publishes() != last_publishes) {
+      last_publishes = ac->get_publishes();
+      record_state();
+    }
+
+    if (!failed && ac->is_failed()) {
+      failed = true;
+      timeline->push_back(format_time(relative_now()) + " failed");
+      std::printf("  %s\n", timeline->back().c_str());
+    }
+  };
+
+  auto idle_until = [&](uint64_t us) {
+    while (!failed && next_loop_us < us) {
+      advance_to(next_loop_us);
+      timed_loop(&totals->idle_ns);
+      next_loop_us += loop_us;
+    }
+  };
+
+  for (const auto &frame : frames) {
+    idle_until(frame.end_us);
+    if (failed)
+      break;
+
+    advance_to(frame.end_us);
+
+    if (options.frames)
+      std::printf("  %s RX %s\n", format_time(frame.start_us).c_str(), format_bytes(frame.bytes).c_str());
+
+    uart.feed(frame.bytes.data(), frame.bytes.size());
+    timed_loop(&totals->frame_ns);
+    next_loop_us = frame.end_us + loop_us;
+  }
+
+  idle_until(end_us);
+
+  totals->entity_publishes += ac->get_publishes();
+  totals->publishes_suppressed += ac->get_publishes_suppressed();
+  totals->frames_unchanged += ac->get_frames_unchanged();
+
+  totals->rx_bytes += rx.size();
+  totals->rx_frames += frames.size();
+  totals->recorded_tx_frames += recorded_tx_frames;
+  totals->duration_s += capture.duration_s();
+  return true;
+}
+
+std::vector<std::string> read_lines(const std::string &path) {
+  std::vector<std::string> lines;
+  std::ifstream file(path);
+  std::string line;
+
+  while (std::getline(file, line))
+    lines.push_back(line);
+
+  return lines;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options = parse_options(argc, argv);
+
+  host::set_virtual_clock(true);
+  host::set_log_level(options.log_level);
+
+  std::vector<std::string> timeline;
+  Totals totals;
+  auto wall_start = std::chrono::steady_clock::now();
+
+  for (const auto &file : options.files) {
+    if (!replay(file, options, &timeline, &totals))
+      return 2;
+  }
+
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+  std::printf("Replayed %zu captures, %.1f s of traffic in %.2f s wall time\n", options.files.size(),
+              totals.duration_s, wall_s);
+  std::printf("RX:\n");
+  std::printf("  %-32s %llu bytes, %llu frames\n", "decoded", (unsigned long long) totals.rx_bytes,
+              (unsigned long long) totals.rx_frames);
+  std::printf("  %-32s %llu parity, %llu framing\n", "errors", (unsigned long long) totals.parity_errors,
+              (unsigned long long) totals.framing_errors);
+  std::printf("TX:\n");
+  std::printf("  %-32s %llu bytes in %llu writes (%llu frames recorded)\n", "written by component",
+              (unsigned long long) totals.tx_bytes, (unsigned long long) totals.tx_frames,
+              (unsigned long long) totals.recorded_tx_frames);
+  std::printf("  %-32s %llu\n", "climate publishes", (unsigned long long) totals.publishes);
+  std::printf("  %-32s %llu, %llu suppressed\n", "entity publishes", (unsigned long long) totals.entity_publishes,
+              (unsigned long long) totals.publishes_suppressed);
+  std::printf("CPU:\n");
+  std::printf("  %-32s %llu\n", "unchanged frames skipped", (unsigned long long) totals.frames_unchanged);
+  totals.frame_ns.print("loop() handling a frame", "ns");
+  totals.idle_ns.print("idle loop()", "ns");
+
+  if (!options.timeline_out.empty()) {
+    std::ofstream out(options.timeline_out);
+    for (const auto &line : timeline)
+      out << line << '\n';
+  }
+
+  if (!options.expect.empty()) {
+    auto expected = read_lines(options.expect);
+    size_t lines = std::max(expected.size(), timeline.size());
+
+    for (size_t i = 0; i < lines; i++) {
+      const std::string &want = i < expected.size() ? expected[i] : std::string("<end>");
+      const std::string &got = i < timeline.size() ? timeline[i] : std::string("<end>");
+
+      if (want != got) {
+        std::printf("Timeline differs from %s at line %zu:\n  expected: %s\n  actual:   %s\n", options.expect.c_str(),
+                    i + 1, want.c_str(), got.c_str());
+        return 1;
+      }
+    }
+
+    std::printf("Timeline matches %s\n", options.expect.c_str());
+  }
+
+  return 0;
+}
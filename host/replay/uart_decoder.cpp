@@ -0,0 +1,65 @@
+#include "uart_decoder.h"
+
+namespace esphome {
+namespace host {
+
+std::vector<UARTByte> decode_uart(const Capture &capture, size_t probe, const UARTFormat &format) {
+  std::vector<UARTByte> bytes;
+
+  const double samples_per_bit = capture.samplerate / format.baud_rate;
+  const int frame_bits = format.even_parity ? 11 : 10;  // Start, 8 data, (parity,) stop
+  const uint64_t n = capture.samples;
+  const auto &channel = capture.channels[probe];
+
+  auto sample_at = [&](uint64_t start, double bit) -> bool {
+    uint64_t index = start + static_cast<uint64_t>(samples_per_bit * (bit + 0.5));
+    return index < n ? capture.sample(probe, index) : true;
+  };
+
+  uint64_t i = 0;
+
+  // Wait for the line to become idle (high) first, it may start low while the unit is powered off
+  while (i < n && !capture.sample(probe, i))
+    i++;
+
+  while (i < n) {
+    // Skip idle samples, a whole byte at a time where possible
+    while (i < n && (i & 7) == 0 && i + 8 <= n && channel[i >> 3] == 0xFF)
+      i += 8;
+    if (i >= n)
+      break;
+    if (capture.sample(probe, i)) {
+      i++;
+      continue;
+    }
+
+    uint64_t start = i;
+    UARTByte byte{};
+    byte.start_us = static_cast<uint64_t>(start / capture.samplerate * 1e6);
+    byte.end_us = static_cast<uint64_t>((start + samples_per_bit * frame_bits) / capture.samplerate * 1e6);
+
+    uint8_t ones = 0;
+    for (int bit = 0; bit < 8; bit++) {
+      if (sample_at(start, 1 + bit)) {
+        byte.value |= 1 << bit;
+        ones++;
+      }
+    }
+
+    if (format.even_parity)
+      byte.parity_error = ((ones + sample_at(start, 9)) & 1) != 0;
+    byte.framing_error = !sample_at(start, frame_bits - 1);
+
+    bytes.push_back(byte);
+
+    // Continue from the middle of the stop bit, then wait for the line to go high if it did not
+    i = start + static_cast<uint64_t>(samples_per_bit * (frame_bits - 0.5));
+    while (i < n && !capture.sample(probe, i))
+      i++;
+  }
+
+  return bytes;
+}
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "dsl_reader.h"
+
+namespace esphome {
+namespace host {
+
+struct UARTByte {
+  uint64_t start_us;   // Falling edge of the start bit, relative to the start of the capture
+  uint64_t end_us;     // End of the stop bit, when a receiver would have the byte
+  uint8_t value;
+  bool parity_error;
+  bool framing_error;  // Stop bit was low
+};
+
+struct UARTFormat {
+  uint32_t baud_rate = 9600;
+  bool even_parity = true;  // Both protocols use 8E1
+};
+
+// Decodes the bytes sent on one probe of a capture
+std::vector<UARTByte> decode_uart(const Capture &capture, size_t probe, const UARTFormat &format);
+
+}  // namespace host
+}  // namespace esphome
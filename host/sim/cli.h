@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+
+namespace esphome {
+namespace host {
+
+// Matches "--name=value" and stores the value
+inline bool parse_option(const char *arg, const char *name, std::string *value) {
+  size_t len = std::strlen(name);
+  if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+    return false;
+
+  *value = arg + len + 1;
+  return true;
+}
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,177 @@
+#include "cnt_simulator.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace host {
+
+static const uint8_t CTRL_HEADER = 0xF0;
+static const uint8_t POLL_HEADER = 0x70;
+
+CNTSimulator::CNTSimulator(const Config &config) : config_(config), random_(config.seed) {}
+
+void CNTSimulator::attach(HostUART *uart) {
+  this->uart_ = uart;
+  this->last_tick_us_ = now_us();
+  uart->set_write_callback([this](const uint8_t *data, size_t len) { this->on_bytes_(data, len); });
+}
+
+void CNTSimulator::set_data(const uint8_t *data) { std::memcpy(this->data_, data, DATA_SIZE); }
+
+uint64_t CNTSimulator::byte_time_us_() const {
+  return (uint64_t(this->config_.bits_per_byte) * 1000000 + this->config_.baud_rate - 1) / this->config_.baud_rate;
+}
+
+void CNTSimulator::tick() {
+  uint64_t now = now_us();
+
+  while (!this->pending_.empty() && this->pending_.front().apply_us <= now) {
+    std::memcpy(this->data_, this->pending_.front().data, DATA_SIZE);
+    this->last_applied_us_ = this->pending_.front().apply_us;
+    this->stats_.controls_applied++;
+    this->pending_.pop_front();
+  }
+
+  while (!this->tx_.empty() && this->tx_.front().first <= now) {
+    this->uart_->feed(this->tx_.front().second);
+    this->tx_.pop_front();
+  }
+
+  this->simulate_room_(now - this->last_tick_us_);
+  this->last_tick_us_ = now;
+}
+
+void CNTSimulator::on_bytes_(const uint8_t *data, size_t len) {
+  uint64_t end_us = now_us() + len * this->byte_time_us_();
+  this->stats_.bytes_received += len;
+
+  for (size_t i = 0; i < len; i++) {
+    if (this->rx_frame_.empty() && data[i] != CTRL_HEADER && data[i] != POLL_HEADER) {
+      this->stats_.invalid_frames++;
+      continue;
+    }
+
+    this->rx_frame_.push_back(data[i]);
+
+    if (this->rx_frame_.size() >= 2 && this->rx_frame_.size() == size_t(this->rx_frame_[1]) + 3) {
+      this->handle_frame_(end_us);
+      this->rx_frame_.clear();
+    }
+  }
+}
+
+void CNTSimulator::handle_frame_(uint64_t end_us) {
+  uint8_t checksum = 0;
+  for (uint8_t b : this->rx_frame_)
+    checksum += b;
+
+  if (checksum != 0 || this->rx_frame_[1] != DATA_SIZE) {
+    this->stats_.invalid_frames++;
+    return;
+  }
+
+  if (this->config_.drop_rate > 0 &&
+      std::uniform_real_distribution<double>(0, 1)(this->random_) < this->config_.drop_rate) {
+    this->stats_.dropped_frames++;
+    return;
+  }
+
+  if (this->rx_frame_[0] == POLL_HEADER) {
+    this->stats_.polls++;
+    this->send_poll_response_(end_us + uint64_t(this->config_.response_delay_ms) * 1000);
+  } else {
+    this->stats_.controls++;
+
+    PendingControl control;
+    std::memcpy(control.data, this->rx_frame_.data() + 2, DATA_SIZE);
+    control.apply_us = end_us + uint64_t(std::uniform_int_distribution<uint32_t>(
+                                             this->config_.apply_delay_min_ms,
+                                             this->config_.apply_delay_max_ms)(this->random_)) *
+                                    1000;
+
+    // The unit only acts on the latest state it was sent
+    this->stats_.controls_superseded += this->pending_.size();
+    this->pending_.clear();
+    this->pending_.push_back(control);
+  }
+}
+
+void CNTSimulator::send_poll_response_(uint64_t start_us) {
+  uint8_t frame[RESPONSE_SIZE] = {};
+
+  frame[0] = POLL_HEADER;
+  frame[1] = RESPONSE_SIZE - 3;
+  std::memcpy(frame + 2, this->data_, DATA_SIZE);
+
+  int8_t inside = static_cast<int8_t>(std::lround(this->inside_temperature_));
+  int8_t outside = static_cast<int8_t>(std::lround(this->outside_temperature_));
+
+  frame[12] = 0x3E;
+  frame[13] = 0x2D;
+  frame[16] = 0x20;
+  frame[17] = 0x85;
+  frame[18] = inside;
+  frame[19] = outside;
+  frame[20] = 0xFF;
+  frame[21] = inside;
+  frame[22] = outside;
+  frame[23] = 0xFF;
+  frame[24] = 0x80;
+  frame[25] = 0x80;
+  frame[26] = 0xFF;
+  frame[27] = 0x80;
+
+  uint16_t raw_power = this->power_ + this->power_offset_;
+  frame[28] = raw_power & 0xFF;
+  frame[29] = raw_power >> 8;
+  frame[30] = this->power_offset_;
+
+  uint8_t checksum = 0;
+  for (size_t i = 0; i < RESPONSE_SIZE - 1; i++)
+    checksum -= frame[i];
+  frame[RESPONSE_SIZE - 1] = checksum;
+
+  if (this->config_.corrupt_rate > 0 &&
+      std::uniform_real_distribution<double>(0, 1)(this->random_) < this->config_.corrupt_rate) {
+    frame[std::uniform_int_distribution<size_t>(0, RESPONSE_SIZE - 1)(this->random_)] ^= 0x10;
+    this->stats_.corrupted_frames++;
+  }
+
+  // Answers never overlap on the wire
+  uint64_t t = std::max(start_us, this->tx_.empty() ? 0 : this->tx_.back().first);
+  for (uint8_t b : frame) {
+    t += this->byte_time_us_();
+    this->tx_.emplace_back(t, b);
+  }
+
+  this->stats_.bytes_sent += RESPONSE_SIZE;
+}
+
+void CNTSimulator::simulate_room_(uint64_t elapsed_us) {
+  double hours = elapsed_us / 3.6e9;
+  bool on = (this->data_[0] & 0x0F) != 0;
+  uint8_t mode = this->data_[0] >> 4;
+  float target = this->data_[1] / 2.0f;
+
+  // The room leaks towards the outside temperature and is pushed towards the target while running
+  float leak = (this->outside_temperature_ - this->inside_temperature_) * 0.2f * hours;
+  float drive = 0;
+  if (on && (mode == 0x03 || mode == 0x04 || mode == 0x00 || mode == 0x02))
+    drive = (target - this->inside_temperature_) * 2.0f * hours;
+  this->inside_temperature_ += leak + drive;
+
+  if (!on) {
+    this->power_ = 0;
+  } else if (mode == 0x06) {
+    this->power_ = 40;
+  } else {
+    float load = std::min(1.0f, std::fabs(target - this->inside_temperature_) / 4.0f);
+    this->power_ = static_cast<uint16_t>(150 + 1000 * load);
+  }
+}
+
+}  // namespace host
+}  // namespace esphome
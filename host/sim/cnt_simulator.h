@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "host/host_uart.h"
+
+namespace esphome {
+namespace host {
+
+/*
+ * Software CZ-TACG1 indoor unit speaking the CN-CNT protocol
+ *
+ * Answers 0x70 polls with full 35 byte frames and applies 0xF0 control frames to its state after a
+ * configurable delay. Bytes are delivered at the configured baud rate using the host clock, call tick()
+ * from the simulation loop.
+ */
+class CNTSimulator {
+ public:
+  struct Config {
+    uint32_t baud_rate = 9600;
+    uint32_t bits_per_byte = 11;      // Start bit, 8 data bits, even parity and stop bit
+    uint32_t response_delay_ms = 40;  // Time between the end of a poll and the start of its answer
+    uint32_t apply_delay_min_ms = 300;
+    uint32_t apply_delay_max_ms = 1500;
+    double drop_rate = 0.0;           // Probability of ignoring a received frame
+    double corrupt_rate = 0.0;        // Probability of flipping a bit in an answer
+    uint32_t seed = 1;
+  };
+
+  struct Stats {
+    uint64_t polls = 0;
+    uint64_t controls = 0;
+    uint64_t controls_applied = 0;
+    uint64_t controls_superseded = 0;  // Controls replaced by a newer one before they were applied
+    uint64_t invalid_frames = 0;
+    uint64_t dropped_frames = 0;
+    uint64_t corrupted_frames = 0;
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+  };
+
+  CNTSimulator() : CNTSimulator(Config()) {}
+  explicit CNTSimulator(const Config &config);
+
+  void attach(HostUART *uart);
+
+  // Delivers due bytes, applies due controls and evolves the room, call at least once per loop
+  void tick();
+
+  // The 10 byte state block as the unit currently reports it
+  const uint8_t *data() const { return this->data_; }
+  void set_data(const uint8_t *data);
+
+  void set_inside_temperature(float temperature) { this->inside_temperature_ = temperature; }
+  void set_outside_temperature(float temperature) { this->outside_temperature_ = temperature; }
+  float inside_temperature() const { return this->inside_temperature_; }
+  float outside_temperature() const { return this->outside_temperature_; }
+  uint16_t power() const { return this->power_; }
+
+  // Time (host clock, us) at which the most recent control frame was applied
+  uint64_t last_applied_us() const { return this->last_applied_us_; }
+
+  const Stats &stats() const { return this->stats_; }
+
+  static const size_t DATA_SIZE = 10;
+  static const size_t RESPONSE_SIZE = 35;
+
+ protected:
+  struct PendingControl {
+    uint64_t apply_us;
+    uint8_t data[DATA_SIZE];
+  };
+
+  void on_bytes_(const uint8_t *data, size_t len);
+  void handle_frame_(uint64_t end_us);
+  void send_poll_response_(uint64_t start_us);
+  void simulate_room_(uint64_t elapsed_us);
+  uint64_t byte_time_us_() const;
+
+  Config config_;
+  Stats stats_;
+  std::mt19937 random_;
+
+  HostUART *uart_{nullptr};
+
+  std::vector<uint8_t> rx_frame_;               // Frame currently being received from the controller
+  std::deque<std::pair<uint64_t, uint8_t>> tx_;  // Bytes to deliver with their arrival time
+  std::deque<PendingControl> pending_;          // Controls waiting to be applied
+  uint64_t last_tick_us_{0};
+  uint64_t last_applied_us_{0};
+
+  uint8_t data_[DATA_SIZE] = {0x34, 0x2B, 0x80, 0xA0, 0x36, 0x40, 0x00, 0x40, 0x00, 0x00};
+  float inside_temperature_{24};
+  float outside_temperature_{18};
+  uint16_t power_{0};
+  uint16_t power_offset_{0x10};
+};
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,456 @@
+/*
+ * Runs PanasonicACCNT against the simulated CZ-TACG1 on the virtual clock and reports
+ * command-to-confirmation latency, poll overhead and CPU time per loop
+ *
+ * Usage: cnt_soak [--days=1] [--loop-ms=16] [--command-interval-s=900] [--burst=1] [--seed=1] [--drop-rate=0]
+ *                 [--corrupt-rate=0] [--apply-min-ms=300] [--apply-max-ms=1500] [--reboots=0] [--log-level=2]
+ *                 [--trace]
+ *
+ * --burst issues that many edits back to back for every command, like an automation setting several fields
+ * --reboots restarts the module that many times, evenly spread over the run. Every time the vertical swing is changed
+ * on the unit while the module is down, like with the remote, and a command is issued as soon as the cached state is
+ * published, before the first poll answer
+ * --trace freezes the packet trace on the first link error and dumps it to stderr at the end, pipe that into
+ * trace_decode
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "cli.h"
+#include "cnt_simulator.h"
+#include "esppac_cnt.h"
+#include "host/host_uart.h"
+#include "panasonic_ac_select.h"
+#include "panasonic_ac_switch.h"
+#include "stats.h"
+
+using namespace esphome;
+
+namespace {
+
+struct Options {
+  double days = 1;
+  uint32_t loop_ms = 16;
+  double command_interval_s = 900;
+  uint32_t burst = 1;
+  uint32_t poll_min_ms = panasonic_ac::CNT::POLL_INTERVAL_MIN;
+  uint32_t poll_max_ms = panasonic_ac::CNT::POLL_INTERVAL_MAX;
+  uint32_t seed = 1;
+  uint32_t reboots = 0;
+  int log_level = ESPHOME_LOG_LEVEL_WARN;
+  bool trace = false;
+  host::CNTSimulator::Config sim;
+};
+
+Options parse_options(int argc, char **argv) {
+  using host::parse_option;
+
+  Options options;
+  std::string value;
+
+  for (int i = 1; i < argc; i++) {
+    if (parse_option(argv[i], "--days", &value))
+      options.days = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--loop-ms", &value))
+      options.loop_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--command-interval-s", &value))
+      options.command_interval_s = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--burst", &value))
+      options.burst = std::max(1, std::atoi(value.c_str()));
+    else if (parse_option(argv[i], "--poll-min-ms", &value))
+      options.poll_min_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--poll-max-ms", &value))
+      options.poll_max_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--seed", &value))
+      options.seed = options.sim.seed = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--drop-rate", &value))
+      options.sim.drop_rate = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--corrupt-rate", &value))
+      options.sim.corrupt_rate = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--apply-min-ms", &value))
+      options.sim.apply_delay_min_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--apply-max-ms", &value))
+      options.sim.apply_delay_max_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--reboots", &value))
+      options.reboots = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--log-level", &value))
+      options.log_level = std::atoi(value.c_str());
+    else if (std::strcmp(argv[i], "--trace") == 0)
+      options.trace = true;
+    else {
+      std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+      std::exit(1);
+    }
+  }
+
+  return options;
+}
+
+// Exposes the protected entry points of the component to the harness
+class SoakCNT : public panasonic_ac::CNT::PanasonicACCNT {
+ public:
+  bool is_ready() const { return this->state_ == panasonic_ac::CNT::ACState::Ready; }
+};
+
+// Counters of the components of all boots
+struct Totals {
+  uint64_t intents_confirmed = 0, intents_timed_out = 0, commands_unconfirmed = 0, commands_merged = 0;
+  uint64_t commands_suppressed = 0, frames_sent = 0, frames_unchanged = 0, climate_publishes = 0, publishes = 0;
+  uint64_t publishes_suppressed = 0, cache_writes = 0, energy_writes = 0, energy_gaps = 0, power_publishes = 0;
+  uint64_t energy_publishes = 0;
+  uint64_t link[panasonic_ac::LINK_COUNTER_COUNT] = {};
+  panasonic_ac::LatencyHistogram transmit_latency, ack_latency, confirm_latency;
+
+  void add(const SoakCNT &ac) {
+    this->intents_confirmed += ac.get_intents_confirmed();
+    this->intents_timed_out += ac.get_intents_timed_out();
+    this->commands_unconfirmed += ac.get_commands_unconfirmed();
+    this->commands_merged += ac.get_commands_merged();
+    this->commands_suppressed += ac.get_commands_suppressed();
+    this->frames_sent += ac.get_frames_sent();
+    this->frames_unchanged += ac.get_frames_unchanged();
+    this->climate_publishes += ac.publish_count;
+    this->publishes += ac.get_publishes();
+    this->publishes_suppressed += ac.get_publishes_suppressed();
+    this->cache_writes += ac.get_cache_writes();
+    this->energy_writes += ac.get_energy_writes();
+    this->energy_gaps += ac.get_energy().gaps();
+    for (size_t i = 0; i < panasonic_ac::LINK_COUNTER_COUNT; i++)
+      this->link[i] += ac.get_link_stats().total(static_cast<panasonic_ac::LinkCounter>(i));
+    this->transmit_latency.merge(ac.get_transmit_latency());
+    this->ack_latency.merge(ac.get_ack_latency());
+    this->confirm_latency.merge(ac.get_confirm_latency());
+  }
+};
+
+// The component and its entities, created anew at every boot
+struct Module {
+  SoakCNT ac;
+  panasonic_ac::PanasonicACSelect vertical_swing, horizontal_swing;
+  panasonic_ac::PanasonicACSwitch nanoex, eco, econavi, mild_dry;
+  sensor::Sensor outside_temperature, inside_temperature, power;
+  sensor::Sensor energy_total, energy_hour, energy_day;
+
+  Module(host::HostUART *uart, const Options &options) {
+    this->ac.set_uart_parent(uart);
+    this->ac.set_poll_interval(options.poll_min_ms, options.poll_max_ms);
+    this->ac.set_trace_freeze_on_error(options.trace);
+
+    this->vertical_swing.traits.set_options(
+        {"Swing", "Auto", "Top", "Middle Top", "Middle", "Middle Bottom", "Bottom"});
+    this->horizontal_swing.traits.set_options({"Swing", "Left", "Center Left", "Center", "Center Right", "Right"});
+
+    this->ac.set_vertical_swing_enable(true);
+    this->ac.set_horizontal_swing_enable(true);
+    this->ac.set_vertical_swing_select(&this->vertical_swing);
+    this->ac.set_horizontal_swing_select(&this->horizontal_swing);
+    this->ac.set_nanoex_switch(&this->nanoex);
+    this->ac.set_eco_switch(&this->eco);
+    this->ac.set_econavi_switch(&this->econavi);
+    this->ac.set_mild_dry_switch(&this->mild_dry);
+    this->ac.set_outside_temperature_sensor(&this->outside_temperature);
+    this->ac.set_inside_temperature_sensor(&this->inside_temperature);
+    this->ac.set_current_power_consumption_sensor(&this->power);
+    this->ac.set_energy_total_sensor(&this->energy_total);
+    this->ac.set_energy_hour_sensor(&this->energy_hour);
+    this->ac.set_energy_day_sensor(&this->energy_day);
+  }
+
+  uint32_t energy_publishes() const {
+    return this->energy_total.publish_count + this->energy_hour.publish_count + this->energy_day.publish_count;
+  }
+};
+
+struct Expectation {
+  std::string name;
+  uint64_t issued_us;
+  std::function<bool()> confirmed;
+  uint32_t suppressed;  // Commands the component had dropped as no-ops when this one was issued
+  bool shown = false;   // Set to true while the published state matches before the unit applied the command
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options = parse_options(argc, argv);
+
+  host::set_virtual_clock(true);
+  host::set_log_level(options.log_level);
+
+  host::HostUART uart;
+  host::CNTSimulator sim(options.sim);
+  sim.attach(&uart);
+
+  host::clear_preferences();
+  auto module = std::make_unique<Module>(&uart, options);
+
+  std::vector<Expectation> pending;
+  host::Samples latency_ms, shown_ms;
+  uint64_t unconfirmed = 0, superseded = 0, reverted = 0;
+
+  // Publishes are deferred to the end of loop(), which only publishes what changed, so the published state is
+  // checked after every loop rather than from a state callback
+  auto confirm_pending = [&]() {
+    uint64_t now = host::now_us();
+    for (auto it = pending.begin(); it != pending.end();) {
+      // Commands the component dropped because nothing would change are never applied by the unit
+      bool sent_or_dropped =
+          sim.last_applied_us() >= it->issued_us || module->ac.get_commands_suppressed() > it->suppressed;
+      bool matches = it->confirmed();
+
+      if (matches && !it->shown) {
+        it->shown = true;
+        shown_ms.add((now - it->issued_us) / 1000.0);
+      } else if (!matches && it->shown) {
+        it->shown = false;  // The published state went back to what it was before the command
+        reverted++;
+      }
+
+      if (sent_or_dropped && matches) {
+        latency_ms.add((now - it->issued_us) / 1000.0);
+        it = pending.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  };
+
+  std::mt19937 random(options.seed);
+  std::exponential_distribution<double> next_command(1.0 / options.command_interval_s);
+
+  const climate::ClimateMode modes[] = {climate::CLIMATE_MODE_COOL, climate::CLIMATE_MODE_HEAT,
+                                        climate::CLIMATE_MODE_DRY, climate::CLIMATE_MODE_HEAT_COOL,
+                                        climate::CLIMATE_MODE_FAN_ONLY, climate::CLIMATE_MODE_OFF};
+  const climate::ClimateFanMode fan_modes[] = {climate::CLIMATE_FAN_AUTO, climate::CLIMATE_FAN_LOW,
+                                               climate::CLIMATE_FAN_MEDIUM, climate::CLIMATE_FAN_HIGH,
+                                               climate::CLIMATE_FAN_QUIET};
+
+  auto issue_command = [&]() {
+    uint64_t now = host::now_us();
+
+    auto expect = [&](const char *name, std::function<bool()> confirmed) {
+      // A later edit of the same field replaces an earlier one that was not confirmed yet
+      for (auto it = pending.begin(); it != pending.end(); ++it) {
+        if (it->name == name) {
+          pending.erase(it);
+          superseded++;
+          break;
+        }
+      }
+
+      pending.push_back({name, now, std::move(confirmed), module->ac.get_commands_suppressed()});
+    };
+
+    switch (std::uniform_int_distribution<int>(0, 3)(random)) {
+      case 0: {
+        climate::ClimateMode mode = modes[std::uniform_int_distribution<int>(0, 5)(random)];
+        expect("mode", [&module, mode]() { return module->ac.mode == mode; });
+        module->ac.make_call().set_mode(mode).perform();
+        break;
+      }
+      case 1: {
+        float target = std::uniform_int_distribution<int>(34, 56)(random) * 0.5f;
+        expect("target", [&module, target]() { return module->ac.target_temperature == target; });
+        module->ac.make_call().set_target_temperature(target).perform();
+        break;
+      }
+      case 2: {
+        climate::ClimateFanMode fan_mode = fan_modes[std::uniform_int_distribution<int>(0, 4)(random)];
+        expect("fan", [&module, fan_mode]() { return module->ac.fan_mode == fan_mode; });
+        module->ac.make_call().set_fan_mode(fan_mode).perform();
+        break;
+      }
+      case 3: {
+        bool state = !module->nanoex.state;
+        expect("nanoex", [&module, state]() { return module->nanoex.state == state; });
+        if (state)
+          module->nanoex.turn_on();
+        else
+          module->nanoex.turn_off();
+        break;
+      }
+    }
+  };
+
+  module->ac.setup();
+
+  const uint64_t loop_us = uint64_t(options.loop_ms) * 1000;
+  const uint64_t end_us = static_cast<uint64_t>(options.days * 86400e6);
+  const uint64_t expectation_timeout_us = 60 * 1000000ULL;
+  uint64_t next_command_us = static_cast<uint64_t>(next_command(random) * 1e6);
+  uint64_t ready_us = 0, boot_us = 0, published_us = 0;
+  uint64_t loops = 0, remote_reverted = 0;
+  uint32_t reboots = 0;
+  uint8_t remote_swing = 0;  // Vertical swing set with the remote during the last reboot
+  host::Histogram loop_ns;
+  host::Samples cold_ready_ms, warm_published_ms, warm_ready_ms;
+  Totals totals;
+  // Energy the unit used, and what integrating the published power sensor gives, as Home Assistant would
+  double simulated_wh = 0, from_power_wh = 0;
+
+  // The unit keeps the vertical swing set with the remote unless a command overwrites it, the soak never sends one
+  auto check_remote = [&]() {
+    if (reboots > 0 && (sim.data()[4] >> 4) != remote_swing)
+      remote_reverted++;
+  };
+
+  auto wall_start = std::chrono::steady_clock::now();
+
+  while (host::now_us() < end_us) {
+    uint64_t now = host::now_us();
+
+    if (reboots < options.reboots && now >= end_us / (options.reboots + 1) * (reboots + 1)) {
+      module->ac.on_safe_shutdown();  // The module reboots like it does for an OTA update
+      totals.add(module->ac);
+      totals.power_publishes += module->power.publish_count;
+      totals.energy_publishes += module->energy_publishes();
+      check_remote();
+      reboots++;
+
+      uint8_t data[host::CNTSimulator::DATA_SIZE];
+      std::memcpy(data, sim.data(), sizeof(data));
+      remote_swing = panasonic_ac::CNT::VERTICAL_SWING.encode(reboots % 2 ? panasonic_ac::CNT::VerticalSwing::Top
+                                                                          : panasonic_ac::CNT::VerticalSwing::Bottom);
+      data[4] = (data[4] & 0x0F) | (remote_swing << 4);
+      sim.set_data(data);
+
+      uart.clear();
+      module = std::make_unique<Module>(&uart, options);
+      module->ac.setup();
+      boot_us = now;
+      ready_us = published_us = 0;
+
+      for (auto &expectation : pending)
+        expectation.suppressed = 0;  // Counted anew by the restarted component
+    }
+
+    sim.tick();
+
+    auto start = std::chrono::steady_clock::now();
+    module->ac.loop();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    loop_ns.add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    loops++;
+
+    confirm_pending();
+
+    now = host::now_us();
+
+    if (published_us == 0 && module->ac.publish_count > 0) {
+      published_us = now;
+      if (reboots > 0 && !module->ac.is_ready()) {
+        warm_published_ms.add((now - boot_us) / 1000.0);
+        issue_command();  // Before the first poll answer, against the cached state
+      }
+    }
+
+    if (ready_us == 0 && module->ac.is_ready()) {
+      ready_us = now;
+      (reboots > 0 ? warm_ready_ms : cold_ready_ms).add((now - boot_us) / 1000.0);
+    }
+
+    if (ready_us != 0 && now >= next_command_us) {
+      for (uint32_t i = 0; i < options.burst; i++)
+        issue_command();
+      next_command_us = now + static_cast<uint64_t>(next_command(random) * 1e6);
+    }
+
+    for (auto it = pending.begin(); it != pending.end();) {
+      if (now - it->issued_us > expectation_timeout_us) {
+        unconfirmed++;
+        it = pending.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    simulated_wh += sim.power() * (loop_us / 3.6e9);
+    if (module->power.has_state())
+      from_power_wh += module->power.state * (loop_us / 3.6e9);
+
+    host::advance_time_us(loop_us);
+  }
+
+  totals.add(module->ac);
+  totals.power_publishes += module->power.publish_count;
+  totals.energy_publishes += module->energy_publishes();
+  check_remote();
+
+  if (options.trace) {
+    host::set_log_level(std::max(options.log_level, ESPHOME_LOG_LEVEL_INFO));
+    module->ac.dump_trace();
+    host::set_log_level(options.log_level);
+  }
+
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  double hours = end_us / 3.6e9;
+  const auto &stats = sim.stats();
+
+  std::printf("CN-CNT soak: %.2f simulated days, %u reboots, in %.2f s wall time (%.0fx)\n", options.days, reboots,
+              wall_s, end_us / 1e6 / wall_s);
+  std::printf("Startup:\n");
+  cold_ready_ms.print("boot -> Ready (no cache)", "ms");
+  warm_published_ms.print("boot -> published (cached)", "ms");
+  warm_ready_ms.print("boot -> Ready (cached)", "ms");
+  std::printf("  %-32s %llu of %u\n", "remote changes reverted", (unsigned long long) remote_reverted, reboots);
+  std::printf("  %-32s %llu (%.1f/day)\n", "state cache writes", (unsigned long long) totals.cache_writes,
+              totals.cache_writes / hours * 24);
+  std::printf("Commands:\n");
+  latency_ms.print("command -> confirmation", "ms");
+  shown_ms.print("command -> published", "ms");
+  std::printf("  %-32s %llu\n", "published state reverted", (unsigned long long) reverted);
+  std::printf("  %-32s %llu confirmed, %llu timed out\n", "requested fields",
+              (unsigned long long) totals.intents_confirmed, (unsigned long long) totals.intents_timed_out);
+  std::printf("  %-32s %llu\n", "unconfirmed after 60 s", (unsigned long long) unconfirmed);
+  std::printf("  %-32s %llu\n", "superseded by a later edit", (unsigned long long) superseded);
+  std::printf("  As timed by the component:\n");
+  host::print_latency("requested -> written", totals.transmit_latency);
+  host::print_latency("written -> answered (next poll)", totals.ack_latency);
+  host::print_latency("requested -> confirmed", totals.confirm_latency);
+  std::printf("  %-32s %llu\n", "never confirmed", (unsigned long long) totals.commands_unconfirmed);
+  std::printf("  %-32s %llu sent, %llu applied, %llu superseded\n", "control frames",
+              (unsigned long long) stats.controls, (unsigned long long) stats.controls_applied,
+              (unsigned long long) stats.controls_superseded);
+  std::printf("  %-32s %llu merged into a pending frame, %llu suppressed as no-ops\n", "edits",
+              (unsigned long long) totals.commands_merged, (unsigned long long) totals.commands_suppressed);
+  std::printf("Energy:\n");
+  double metered_wh = module->energy_total.state * 1000.0;
+  std::printf("  %-32s %.3f kWh\n", "used by the unit", simulated_wh / 1000.0);
+  std::printf("  %-32s %.3f kWh (%+.2f%%)\n", "metered by the component", metered_wh / 1000.0,
+              (metered_wh - simulated_wh) / simulated_wh * 100.0);
+  std::printf("  %-32s %.3f kWh (%+.2f%%)\n", "integrated from published power", from_power_wh / 1000.0,
+              (from_power_wh - simulated_wh) / simulated_wh * 100.0);
+  std::printf("  %-32s %llu energy, 3 sensors (%.1f/h), %llu power (%.1f/h)\n", "sensor publishes",
+              (unsigned long long) totals.energy_publishes, totals.energy_publishes / hours,
+              (unsigned long long) totals.power_publishes, totals.power_publishes / hours);
+  std::printf("  %-32s %llu (%.1f/day), %llu gaps not counted\n", "energy totals writes",
+              (unsigned long long) totals.energy_writes, totals.energy_writes / hours * 24,
+              (unsigned long long) totals.energy_gaps);
+  std::printf("Bus:\n");
+  std::printf("  %-32s %llu\n", "frames sent by component", (unsigned long long) totals.frames_sent);
+  std::printf("  %-32s %llu (%.1f/h)\n", "polls", (unsigned long long) stats.polls, stats.polls / hours);
+  std::printf("  %-32s %.0f B/h to unit, %.0f B/h from unit\n", "traffic", stats.bytes_received / hours,
+              stats.bytes_sent / hours);
+  std::printf("  %-32s %llu invalid, %llu dropped, %llu corrupted\n", "frames", (unsigned long long) stats.invalid_frames,
+              (unsigned long long) stats.dropped_frames, (unsigned long long) stats.corrupted_frames);
+  std::printf("Link, as counted by the component:\n");
+  host::print_link(totals.link);
+  std::printf("CPU:\n");
+  loop_ns.print("loop()", "ns");
+  std::printf("  %-32s %llu of %llu polls\n", "unchanged polls skipped", (unsigned long long) totals.frames_unchanged,
+              (unsigned long long) stats.polls);
+  std::printf("  %-32s %llu (%.1f/h)\n", "climate publishes", (unsigned long long) totals.climate_publishes,
+              totals.climate_publishes / hours);
+  std::printf("  %-32s %llu (%.1f/h), %llu suppressed\n", "entity publishes", (unsigned long long) totals.publishes,
+              totals.publishes / hours, (unsigned long long) totals.publishes_suppressed);
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "esppac_latency.h"
+
+namespace esphome {
+namespace host {
+
+/*
+ * Keeps every sample, meant for sparse events such as commands
+ */
+class Samples {
+ public:
+  void add(double value) {
+    this->values_.push_back(value);
+    this->sorted_ = false;
+  }
+
+  size_t count() const { return this->values_.size(); }
+
+  double percentile(double p) {
+    if (this->values_.empty())
+      return NAN;
+
+    this->sort_();
+    size_t index = static_cast<size_t>(p / 100.0 * (this->values_.size() - 1) + 0.5);
+    return this->values_[std::min(index, this->values_.size() - 1)];
+  }
+
+  double mean() const {
+    if (this->values_.empty())
+      return NAN;
+
+    double sum = 0;
+    for (double v : this->values_)
+      sum += v;
+    return sum / this->values_.size();
+  }
+
+  double max() {
+    this->sort_();
+    return this->values_.empty() ? NAN : this->values_.back();
+  }
+
+  void print(const char *name, const char *unit) {
+    std::printf("  %-32s n=%-8zu mean=%-10.2f p50=%-10.2f p95=%-10.2f max=%.2f %s\n", name, this->count(), this->mean(),
+                this->percentile(50), this->percentile(95), this->max(), unit);
+  }
+
+ protected:
+  void sort_() {
+    if (!this->sorted_)
+      std::sort(this->values_.begin(), this->values_.end());
+    this->sorted_ = true;
+  }
+
+  std::vector<double> values_;
+  bool sorted_{true};
+};
+
+/*
+ * Constant memory histogram with four logarithmic buckets per power of two, meant for per-loop timings
+ */
+class Histogram {
+ public:
+  void add(uint64_t value) {
+    this->buckets_[bucket_of(value)]++;
+    this->count_++;
+    this->sum_ += value;
+    this->max_ = std::max(this->max_, value);
+  }
+
+  uint64_t count() const { return this->count_; }
+  double mean() const { return this->count_ == 0 ? NAN : double(this->sum_) / this->count_; }
+  uint64_t max() const { return this->max_; }
+
+  // Upper bound of the bucket containing the given percentile
+  double percentile(double p) const {
+    if (this->count_ == 0)
+      return NAN;
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * this->count_));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+      seen += this->buckets_[i];
+      if (seen >= target && seen > 0)
+        return upper_bound_of(i);
+    }
+    return double(this->max_);
+  }
+
+  void print(const char *name, const char *unit) const {
+    std::printf("  %-32s n=%-8llu mean=%-10.2f p50<=%-9.0f p95<=%-9.0f max=%llu %s\n", name,
+                (unsigned long long) this->count(), this->mean(), this->percentile(50), this->percentile(95),
+                (unsigned long long) this->max(), unit);
+  }
+
+ protected:
+  static constexpr size_t BUCKETS = 4 * 64;
+
+  static size_t bucket_of(uint64_t value) {
+    if (value < 4)
+      return value;
+
+    int log2 = 63 - __builtin_clzll(value);
+    size_t sub = (value >> (log2 - 2)) & 0x03;
+    return std::min<size_t>(4 * (log2 - 1) + sub, BUCKETS - 1);
+  }
+
+  static double upper_bound_of(size_t bucket) {
+    if (bucket < 4)
+      return bucket;
+
+    size_t log2 = bucket / 4 + 1;
+    size_t sub = bucket % 4;
+    return std::ldexp(1.0, log2) + std::ldexp(double(sub + 1), log2 - 2) - 1;
+  }
+
+  uint64_t buckets_[BUCKETS] = {};
+  uint64_t count_{0};
+  uint64_t sum_{0};
+  uint64_t max_{0};
+};
+
+// Prints a histogram kept by the component in the format of the ones above
+inline void print_latency(const char *name, const panasonic_ac::LatencyHistogram &latency) {
+  std::printf("  %-32s n=%-8u p50<=%-9u p95<=%-9u max=%u ms\n", name, latency.count(), latency.percentile(50),
+              latency.percentile(95), latency.max());
+}
+
+// Prints the link counters kept by the component, summed over all sessions
+inline void print_link(const uint64_t (&link)[panasonic_ac::LINK_COUNTER_COUNT]) {
+  using namespace panasonic_ac;
+  auto n = [&link](LinkCounter counter) { return (unsigned long long) link[counter]; };
+
+  std::printf("  %-32s %llu in (%llu B), %llu out (%llu B)\n", "frames", n(LINK_FRAMES_IN), n(LINK_BYTES_IN),
+              n(LINK_FRAMES_OUT), n(LINK_BYTES_OUT));
+  std::printf("  %-32s %llu length, %llu header, %llu length mismatch, %llu checksum\n", "dropped frames",
+              n(LINK_DROPS_LENGTH), n(LINK_DROPS_HEADER), n(LINK_DROPS_LENGTH_MISMATCH), n(LINK_DROPS_CHECKSUM));
+  std::printf("  %-32s %llu resends, %llu counter corrections, %llu resyncs\n", "recovered", n(LINK_RESENDS),
+              n(LINK_COUNTER_CORRECTIONS), n(LINK_RESYNCS));
+  std::printf("  %-32s %llu B overflowed, %llu frames not sent\n", "lost", n(LINK_OVERFLOWS), n(LINK_TX_DROPS));
+}
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,360 @@
+#include "wlan_simulator.h"
+
+#include <algorithm>
+
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace host {
+
+static const uint8_t HEADER = 0x5A;
+
+// Answers recorded from a real unit, keyed by the packet type of the request
+struct CannedAnswer {
+  uint8_t request_high;
+  uint8_t request_low;
+  std::vector<uint8_t> payload;
+};
+
+static const std::vector<CannedAnswer> HANDSHAKE_ANSWERS = {
+    {0x00, 0x09, {0x00, 0x02}},
+    {0x00, 0x0C, {0x00}},
+    {0x00, 0x10, {0x00, 0x20}},
+    {0x00, 0x11, {0x00, 0x00, 0x01, 0x00, 0x01, 0x0A, 0x15, 0x43, 0x53, 0x2D, 0x5A, 0x32, 0x35, 0x56,
+                  0x4B, 0x45, 0x57, 0x2B, 0x34, 0x39, 0x36, 0x32, 0x33, 0x32, 0x32, 0x37, 0x33, 0x30,
+                  0x0B, 0x02, 0x01, 0x2C, 0x0C, 0x14, 0x43, 0x53, 0x2D, 0x31, 0x39, 0x31, 0x00, 0x00,
+                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {0x00, 0x12, {0x00, 0x01, 0x10, 0x11, 0x12}},
+    {0x00, 0x41, {0x00, 0x01}},
+    {0x01, 0x4C, {0x00, 0x01}},
+    {0x10, 0x00, {0x00, 0x01, 0x01, 0x30, 0x01}},
+    {0x10, 0x01, {0x00, 0x01, 0x30, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x14, 0x00, 0x80, 0xE2, 0x01, 0x00,
+                  0x85, 0x42, 0x04, 0x00, 0x86, 0x62, 0x2E, 0x00, 0x88, 0x62, 0x01, 0x00, 0xA0, 0xE2, 0x01,
+                  0x00, 0xA1, 0xE2, 0x01, 0x00, 0xA4, 0xE2, 0x01, 0x00, 0xA5, 0xE2, 0x01, 0x00, 0xB0, 0xE2,
+                  0x01, 0x00, 0xB2, 0xE2, 0x01, 0x00, 0xBB, 0x42, 0x01, 0x00, 0xBE, 0x42, 0x01, 0x02, 0x20,
+                  0x62, 0x01, 0x02, 0x21, 0x62, 0x01, 0x02, 0x31, 0xE2, 0x01, 0x02, 0x32, 0x62, 0x01, 0x02,
+                  0x33, 0xE2, 0x01, 0x02, 0x34, 0xE2, 0x01, 0x02, 0x35, 0xE2, 0x01, 0x02, 0x42, 0x82, 0x01}},
+    {0x00, 0x18, {0x00}},
+    {0x01, 0x00, {0x00}},
+};
+
+// Multi-byte values returned for key 0x86 and 0x85
+static const std::vector<uint8_t> VALUE_86 = {0x2A, 0x00, 0x00, 0x0B, 0x01, 0x01, 0x48, 0x30, 0x30, 0x30, 0x00, 0x00,
+                                              0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                              0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                              0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const std::vector<uint8_t> VALUE_85 = {0x00, 0x00, 0x18, 0x7B};
+
+WLANSimulator::WLANSimulator(const Config &config) : config_(config), random_(config.seed) {
+  this->values_[0x80] = 0x30;  // Power on
+  this->values_[0xB0] = 0x42;  // Cool
+  this->values_[0x31] = 0x2F;  // 23.5 degrees
+  this->values_[0xA0] = 0x41;  // Fan auto
+  this->values_[0xA1] = 0x42;  // Swing off
+  this->values_[0xA4] = 0x43;  // Vertical center
+  this->values_[0xA5] = 0x43;  // Horizontal center
+  this->values_[0xB2] = 0x41;  // Normal
+  this->values_[0x32] = 0x41;
+  this->values_[0x33] = 0x42;  // nanoeX off
+  this->values_[0x34] = 0x41;
+  this->values_[0x35] = 0x41;
+  this->values_[0x88] = 0x42;
+  this->values_[0xBB] = 0x16;  // 22 degrees inside
+  this->values_[0xBE] = 0x14;  // 20 degrees outside
+  this->values_[0x20] = 0x42;
+  this->values_[0x21] = 0x41;
+}
+
+void WLANSimulator::attach(HostUART *uart) {
+  this->uart_ = uart;
+  uart->set_write_callback([this](const uint8_t *data, size_t len) { this->on_bytes_(data, len); });
+
+  uint64_t now = now_us();
+  if (this->config_.ping_interval_ms != 0)
+    this->next_ping_us_ = now + uint64_t(this->config_.ping_interval_ms) * 1000;
+  if (this->config_.report_interval_ms != 0)
+    this->next_report_us_ = now + uint64_t(this->config_.report_interval_ms) * 1000;
+}
+
+uint64_t WLANSimulator::byte_time_us_() const {
+  return (uint64_t(this->config_.bits_per_byte) * 1000000 + this->config_.baud_rate - 1) / this->config_.baud_rate;
+}
+
+uint8_t WLANSimulator::page_of(uint8_t key) {
+  switch (key) {
+    case 0x20:
+    case 0x21:
+    case 0x31:
+    case 0x32:
+    case 0x33:
+    case 0x34:
+    case 0x35:
+    case 0x42:
+      return 0x02;
+    default:
+      return 0x00;
+  }
+}
+
+uint8_t WLANSimulator::next_counter_() {
+  this->counter_ = this->counter_ == 0xFE ? 0x01 : this->counter_ + 1;
+  return this->counter_;
+}
+
+void WLANSimulator::tick() {
+  uint64_t now = now_us();
+
+  if (this->next_ping_us_ != 0 && now >= this->next_ping_us_) {
+    this->stats_.pings++;
+    this->send_(this->next_counter_(), 0x01, 0x01, {}, now);
+    this->expected_counters_.push_back(this->counter_);
+    this->next_ping_us_ = now + uint64_t(this->config_.ping_interval_ms) * 1000;
+  }
+
+  if (this->next_report_us_ != 0 && now >= this->next_report_us_) {
+    static const uint8_t TEMPERATURES[] = {0x2C, 0x2E, 0x30, 0x32, 0x34};
+    static const uint8_t FAN_MODES[] = {0x41, 0x33, 0x34, 0x35};
+
+    if (std::uniform_int_distribution<int>(0, 1)(this->random_) == 0)
+      this->remote_change(0x31, TEMPERATURES[std::uniform_int_distribution<int>(0, 4)(this->random_)]);
+    else
+      this->remote_change(0xA0, FAN_MODES[std::uniform_int_distribution<int>(0, 3)(this->random_)]);
+
+    std::exponential_distribution<double> interval(1.0 / this->config_.report_interval_ms);
+    this->next_report_us_ = now + static_cast<uint64_t>(interval(this->random_) * 1000) + 1;
+  }
+
+  while (!this->tx_.empty() && this->tx_.front().first <= now) {
+    this->uart_->feed(this->tx_.front().second);
+    this->tx_.pop_front();
+  }
+}
+
+void WLANSimulator::power_cycle() {
+  this->session_ = false;
+  this->expected_counters_.clear();
+  this->tx_.clear();
+  this->rx_frame_.clear();
+}
+
+void WLANSimulator::remote_change(uint8_t key, uint8_t value) {
+  this->values_[key] = value;
+  this->send_report_({{key, value}}, now_us());
+}
+
+void WLANSimulator::on_bytes_(const uint8_t *data, size_t len) {
+  uint64_t end_us = now_us() + len * this->byte_time_us_();
+  this->stats_.bytes_received += len;
+
+  for (size_t i = 0; i < len; i++) {
+    if (this->rx_frame_.empty() && data[i] != HEADER) {
+      this->stats_.invalid_frames++;
+      continue;
+    }
+
+    this->rx_frame_.push_back(data[i]);
+
+    if (this->rx_frame_.size() >= 6 &&
+        this->rx_frame_.size() == size_t((this->rx_frame_[4] << 8) | this->rx_frame_[5]) + 7) {
+      this->handle_frame_(end_us);
+      this->rx_frame_.clear();
+    }
+  }
+}
+
+void WLANSimulator::handle_frame_(uint64_t end_us) {
+  uint8_t checksum = 0;
+  for (uint8_t b : this->rx_frame_)
+    checksum += b;
+
+  if (checksum != 0) {
+    this->stats_.invalid_frames++;
+    return;
+  }
+
+  uint8_t counter = this->rx_frame_[1];
+  uint8_t high = this->rx_frame_[2];
+  uint8_t low = this->rx_frame_[3];
+  uint64_t at_us = end_us + uint64_t(this->config_.response_delay_ms) * 1000;
+  bool answer = (low & 0x80) != 0;
+
+  // Count requests before dropping them so the retransmission that follows is seen as a resend
+  if (!answer) {
+    this->stats_.requests++;
+    if (this->has_last_request_ && counter == this->last_request_counter_)
+      this->stats_.resends++;
+    this->last_request_counter_ = counter;
+    this->has_last_request_ = true;
+  }
+
+  if (this->config_.drop_rate > 0 &&
+      std::uniform_real_distribution<double>(0, 1)(this->random_) < this->config_.drop_rate) {
+    this->stats_.dropped_frames++;
+    return;
+  }
+
+  // Answers to packets we sent: pings, reports and the two unsolicited handshake packets
+  if (answer) {
+    // Packets answered out of order or not at all are given up on, the rest must match
+    auto it = std::find(this->expected_counters_.begin(), this->expected_counters_.end(), counter);
+    if (it == this->expected_counters_.end()) {
+      this->stats_.counter_mismatches++;
+      return;
+    }
+
+    this->expected_counters_.erase(this->expected_counters_.begin(), it + 1);
+
+    if (high == 0x01 && low == 0x81)
+      this->stats_.pings_answered++;
+    else if (high == 0x10 && low == 0x8A)
+      this->stats_.reports_acked++;
+
+    return;
+  }
+
+  if (high == 0x00 && low == 0x06) {
+    this->expected_counters_.clear();  // The module rebooted, nothing we sent before will be answered
+    this->session_ = false;            // and it starts a new session
+    return;                            // First handshake packet is never answered
+  }
+
+  // Outside of a session polls and sets are ignored, apart from the set of handshake 13 that starts one
+  bool starts_session = high == 0x10 && low == 0x08 && this->rx_frame_.size() > 12 && this->rx_frame_[12] == 0x42;
+  if (!this->session_ && high == 0x10 && (low == 0x08 || low == 0x09) && !starts_session) {
+    this->stats_.sessionless++;
+    return;
+  }
+
+  if (high == 0x10 && low == 0x08) {
+    this->handle_set_(counter, at_us);
+    return;
+  }
+
+  if (high == 0x10 && low == 0x09) {
+    this->handle_poll_(counter, at_us);
+    return;
+  }
+
+  for (const auto &answer : HANDSHAKE_ANSWERS) {
+    if (answer.request_high == high && answer.request_low == low) {
+      if (high == 0x01 && low == 0x00 && this->rx_frame_.size() > 7 && this->rx_frame_[6] == 0x11)
+        this->stats_.handshakes++;
+
+      this->send_(counter, high, low | 0x80, answer.payload, at_us);
+      return;
+    }
+  }
+
+  this->stats_.unknown++;
+}
+
+void WLANSimulator::handle_set_(uint8_t counter, uint64_t at_us) {
+  this->stats_.sets++;
+
+  const auto &frame = this->rx_frame_;
+  size_t end = frame.size() - 1;
+  std::vector<Entry> changes;
+  std::vector<uint8_t> ack = {0x00, 0x01, 0x30, 0x01, 0x00};
+  bool handshake = false;
+
+  // Key/value pairs: page, key, length, value
+  for (size_t i = 11; i + 3 <= end; i += 4) {
+    uint8_t key = frame[i + 1];
+    uint8_t value = frame[i + 3];
+
+    ack.push_back(page_of(key));
+    ack.push_back(key);
+    ack.push_back(0x00);
+    ack[4]++;
+
+    if (key == 0x42) {
+      handshake = true;
+      this->session_ = true;
+    } else if (this->values_[key] != value) {
+      this->values_[key] = value;
+      changes.push_back({key, value});
+    }
+  }
+
+  this->send_(counter, 0x10, 0x88, ack, at_us);
+
+  if (handshake) {
+    // The unit sends its rx counter and a second packet that both need an answer
+    uint64_t gap_us = uint64_t(this->config_.unsolicited_gap_ms) * 1000;
+    this->send_(this->next_counter_(), 0x01, 0x09, {}, this->last_tx_us_ + gap_us);
+    this->expected_counters_.push_back(this->counter_);
+    this->send_(this->next_counter_(), 0x00, 0x20, {}, this->last_tx_us_ + gap_us);
+    this->expected_counters_.push_back(this->counter_);
+  } else if (!changes.empty()) {
+    this->send_report_(changes, this->last_tx_us_ + uint64_t(this->config_.report_delay_ms) * 1000);
+  }
+}
+
+void WLANSimulator::handle_poll_(uint8_t counter, uint64_t at_us) {
+  this->stats_.polls++;
+
+  const auto &frame = this->rx_frame_;
+  size_t end = frame.size() - 1;
+  std::vector<uint8_t> payload = {0x00, 0x01, 0x30, 0x01, 0x00};
+
+  // Requested keys: page, key, 0x00
+  for (size_t i = 11; i + 2 <= end; i += 3) {
+    uint8_t key = frame[i + 1];
+
+    payload.push_back(page_of(key));
+    payload.push_back(key);
+    payload[4]++;
+
+    if (key == 0x86 || key == 0x85) {
+      const auto &value = key == 0x86 ? VALUE_86 : VALUE_85;
+      payload.push_back(value.size());
+      payload.insert(payload.end(), value.begin(), value.end());
+    } else {
+      payload.push_back(0x01);
+      payload.push_back(this->values_[key]);
+    }
+  }
+
+  this->send_(counter, 0x10, 0x89, payload, at_us);
+}
+
+void WLANSimulator::send_report_(const std::vector<Entry> &entries, uint64_t at_us) {
+  std::vector<uint8_t> payload = {0x00, 0x01, 0x30, 0x01, static_cast<uint8_t>(entries.size())};
+
+  for (const auto &entry : entries) {
+    payload.push_back(page_of(entry.key));
+    payload.push_back(entry.key);
+    payload.push_back(0x01);
+    payload.push_back(entry.value);
+  }
+
+  this->stats_.reports++;
+  this->send_(this->next_counter_(), 0x10, 0x0A, payload, at_us);
+  this->expected_counters_.push_back(this->counter_);
+  this->last_report_us_ = this->last_tx_us_;
+}
+
+void WLANSimulator::send_(uint8_t counter, uint8_t type_high, uint8_t type_low, const std::vector<uint8_t> &payload,
+                          uint64_t at_us) {
+  std::vector<uint8_t> frame = {HEADER, counter, type_high, type_low, static_cast<uint8_t>(payload.size() >> 8),
+                                static_cast<uint8_t>(payload.size() & 0xFF)};
+  frame.insert(frame.end(), payload.begin(), payload.end());
+
+  uint8_t checksum = 0;
+  for (uint8_t b : frame)
+    checksum -= b;
+  frame.push_back(checksum);
+
+  // Packets never overlap on the wire
+  uint64_t t = std::max(at_us, this->last_tx_us_);
+  for (uint8_t b : frame) {
+    t += this->byte_time_us_();
+    this->tx_.emplace_back(t, b);
+  }
+
+  this->last_tx_us_ = t;
+  this->stats_.bytes_sent += frame.size();
+}
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "host/host_uart.h"
+
+namespace esphome {
+namespace host {
+
+/*
+ * Software indoor unit speaking the DNSK-P11 (CN-WLAN) protocol
+ *
+ * Answers the 16 step handshake with the payloads recorded in protocol/logic_analyzer/other/init.dsl,
+ * acknowledges set commands and follows them up with a report, answers polls with the requested keys
+ * and sends pings and unsolicited reports with its own rolling counter. Call tick() from the simulation loop.
+ *
+ * Polls and sets are only answered within a session, which handshake 13 starts. The session survives restarts of the
+ * module and ends with the first handshake packet or a power cycle of the unit.
+ */
+class WLANSimulator {
+ public:
+  struct Config {
+    uint32_t baud_rate = 9600;
+    uint32_t bits_per_byte = 11;         // Start bit, 8 data bits, even parity and stop bit
+    uint32_t response_delay_ms = 70;     // Time between the end of a request and the start of its answer
+    uint32_t unsolicited_gap_ms = 100;   // Gap between consecutive unsolicited packets
+    uint32_t report_delay_ms = 100;      // Time between a set acknowledgement and the report of the change
+    uint32_t ping_interval_ms = 60000;   // 0 disables pings
+    uint32_t report_interval_ms = 0;     // Mean interval of unsolicited reports (remote control use), 0 disables
+    double drop_rate = 0.0;              // Probability of ignoring a received frame
+    uint32_t seed = 1;
+  };
+
+  struct Stats {
+    uint64_t requests = 0;
+    uint64_t resends = 0;            // Requests repeating the counter of the previous request
+    uint64_t handshakes = 0;         // Completed handshakes (answers to the last handshake packet)
+    uint64_t polls = 0;
+    uint64_t sets = 0;
+    uint64_t pings = 0;
+    uint64_t pings_answered = 0;
+    uint64_t reports = 0;
+    uint64_t reports_acked = 0;
+    uint64_t counter_mismatches = 0;  // Answers to unsolicited packets carrying the wrong counter
+    uint64_t sessionless = 0;         // Polls and sets ignored because no session was established
+    uint64_t unknown = 0;
+    uint64_t invalid_frames = 0;
+    uint64_t dropped_frames = 0;
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+  };
+
+  WLANSimulator() : WLANSimulator(Config()) {}
+  explicit WLANSimulator(const Config &config);
+
+  void attach(HostUART *uart);
+
+  // Delivers due bytes and sends due pings and reports, call at least once per loop
+  void tick();
+
+  uint8_t value(uint8_t key) const { return this->values_[key]; }
+  void set_value(uint8_t key, uint8_t value) { this->values_[key] = value; }
+
+  // Loses the session and everything in flight, as if the unit lost power
+  void power_cycle();
+
+  // Changes a value as if done with the remote control and reports it
+  void remote_change(uint8_t key, uint8_t value);
+
+  // Time (host clock, us) at which the most recent report was sent
+  uint64_t last_report_us() const { return this->last_report_us_; }
+
+  const Stats &stats() const { return this->stats_; }
+
+ protected:
+  struct Entry {
+    uint8_t key;
+    uint8_t value;
+  };
+
+  void on_bytes_(const uint8_t *data, size_t len);
+  void handle_frame_(uint64_t end_us);
+  void handle_set_(uint8_t counter, uint64_t at_us);
+  void handle_poll_(uint8_t counter, uint64_t at_us);
+  void send_report_(const std::vector<Entry> &entries, uint64_t at_us);
+
+  void send_(uint8_t counter, uint8_t type_high, uint8_t type_low, const std::vector<uint8_t> &payload, uint64_t at_us);
+  uint8_t next_counter_();
+  uint64_t byte_time_us_() const;
+
+  static uint8_t page_of(uint8_t key);
+
+  Config config_;
+  Stats stats_;
+  std::mt19937 random_;
+
+  HostUART *uart_{nullptr};
+
+  std::vector<uint8_t> rx_frame_;               // Frame currently being received from the module
+  std::deque<std::pair<uint64_t, uint8_t>> tx_;  // Bytes to deliver with their arrival time
+  uint64_t last_tx_us_{0};                      // Arrival time of the last scheduled byte
+
+  uint8_t counter_{0x70};          // Counter used for unsolicited packets
+  uint8_t last_request_counter_{0};
+  bool has_last_request_{false};
+  bool session_{false};  // Whether a handshake established a session
+  std::deque<uint8_t> expected_counters_;  // Counters of unsolicited packets still waiting for an answer
+
+  uint64_t next_ping_us_{0};
+  uint64_t next_report_us_{0};
+  uint64_t last_report_us_{0};
+
+  uint8_t values_[256] = {};
+};
+
+}  // namespace host
+}  // namespace esphome
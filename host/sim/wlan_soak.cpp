@@ -0,0 +1,311 @@
+/*
+ * Runs PanasonicACWLAN against the simulated DNSK-P11 unit on the virtual clock and reports
+ * time-to-Ready, resend rates and report processing cost
+ *
+ * Usage: wlan_soak [--reboots=10] [--session-s=3600] [--loop-ms=16] [--command-interval-s=600]
+ *                  [--report-interval-ms=0] [--drop-rate=0] [--power-cycle-rate=0] [--seed=1] [--log-level=2]
+ *                  [--trace]
+ *
+ * Reboots are restarts of the module only, it resumes the session of the unit. --power-cycle-rate is the share of
+ * reboots in which the unit lost power too, which forces the full handshake.
+ * --trace freezes the packet trace on the first link error and dumps it to stderr at the end of every boot, pipe that
+ * into trace_decode
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "cli.h"
+#include "esppac_wlan.h"
+#include "host/host_uart.h"
+#include "panasonic_ac_switch.h"
+#include "stats.h"
+#include "wlan_simulator.h"
+
+using namespace esphome;
+
+namespace {
+
+struct Options {
+  uint32_t reboots = 10;
+  double session_s = 3600;
+  uint32_t loop_ms = 16;
+  double command_interval_s = 600;
+  double power_cycle_rate = 0;
+  uint32_t seed = 1;
+  int log_level = ESPHOME_LOG_LEVEL_WARN;
+  bool trace = false;
+  host::WLANSimulator::Config sim;
+};
+
+Options parse_options(int argc, char **argv) {
+  using host::parse_option;
+
+  Options options;
+  std::string value;
+
+  for (int i = 1; i < argc; i++) {
+    if (parse_option(argv[i], "--reboots", &value))
+      options.reboots = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--session-s", &value))
+      options.session_s = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--loop-ms", &value))
+      options.loop_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--command-interval-s", &value))
+      options.command_interval_s = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--report-interval-ms", &value))
+      options.sim.report_interval_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--ping-interval-ms", &value))
+      options.sim.ping_interval_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--response-delay-ms", &value))
+      options.sim.response_delay_ms = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--drop-rate", &value))
+      options.sim.drop_rate = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--power-cycle-rate", &value))
+      options.power_cycle_rate = std::atof(value.c_str());
+    else if (parse_option(argv[i], "--seed", &value))
+      options.seed = options.sim.seed = std::atoi(value.c_str());
+    else if (parse_option(argv[i], "--log-level", &value))
+      options.log_level = std::atoi(value.c_str());
+    else if (std::strcmp(argv[i], "--trace") == 0)
+      options.trace = true;
+    else {
+      std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+      std::exit(1);
+    }
+  }
+
+  return options;
+}
+
+// Exposes the protected state of the component to the harness
+class SoakWLAN : public panasonic_ac::WLAN::PanasonicACWLAN {
+ public:
+  bool is_ready() const { return this->state_ == panasonic_ac::WLAN::ACState::Ready; }
+  uint64_t last_packet_received_us() const { return uint64_t(this->last_packet_received_) * 1000; }
+};
+
+struct Expectation {
+  uint64_t issued_us;
+  std::function<bool()> confirmed;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options = parse_options(argc, argv);
+
+  host::set_virtual_clock(true);
+  host::set_log_level(options.log_level);
+
+  host::HostUART uart;
+  host::WLANSimulator sim(options.sim);
+  sim.attach(&uart);
+
+  std::mt19937 random(options.seed);
+  std::exponential_distribution<double> next_command(1.0 / options.command_interval_s);
+
+  host::Samples handshake_ready_ms, resume_ready_ms, latency_ms;
+  host::Histogram loop_ns, report_loop_ns;
+  uint64_t failed_sessions = 0, unconfirmed = 0, loops = 0, frames_resent = 0, resend_give_ups = 0;
+  uint64_t publishes = 0, publishes_suppressed = 0, frames_unchanged = 0, intents_confirmed = 0, intents_timed_out = 0;
+  panasonic_ac::LatencyHistogram transmit_latency, ack_latency, confirm_latency;
+  uint64_t commands_unconfirmed = 0;
+  uint64_t raw_publishes = 0, session_writes = 0;
+  float raw_21 = NAN, raw_86 = NAN;
+  uint64_t link[panasonic_ac::LINK_COUNTER_COUNT] = {};
+  const uint64_t loop_us = uint64_t(options.loop_ms) * 1000;
+  const uint64_t expectation_timeout_us = 60 * 1000000ULL;
+
+  auto wall_start = std::chrono::steady_clock::now();
+  uint64_t start_us = host::now_us();
+
+  for (uint32_t session = 0; session <= options.reboots; session++) {
+    uart.clear();
+
+    if (session > 0 && std::uniform_real_distribution<double>(0, 1)(random) < options.power_cycle_rate)
+      sim.power_cycle();
+    uint64_t handshakes_before = sim.stats().handshakes;
+
+    auto ac = std::make_unique<SoakWLAN>();
+    panasonic_ac::PanasonicACSwitch nanoex;
+    sensor::Sensor outside_temperature;
+    sensor::Sensor raw_sensor_21, raw_sensor_86;  // Declared as raw sensors, as YAML would
+    ac->set_uart_parent(&uart);
+    ac->set_nanoex_switch(&nanoex);
+    ac->set_outside_temperature_sensor(&outside_temperature);
+    ac->set_trace_freeze_on_error(options.trace);
+    ac->add_raw_sensor(0x21, panasonic_ac::RawType::U8, 1.0f, 0, &raw_sensor_21);
+    ac->add_raw_sensor(0x86, panasonic_ac::RawType::U8, 1.0f, 3, &raw_sensor_86);
+
+    std::vector<Expectation> pending;
+    // Publishes are deferred to the end of loop() and skipped when nothing changed, so the published state is checked
+    // after every loop rather than from a state callback, once the component has handled a frame sent after the report
+    auto confirm_pending = [&]() {
+      uint64_t now = host::now_us();
+      for (auto it = pending.begin(); it != pending.end();) {
+        bool reported = sim.last_report_us() >= it->issued_us && ac->last_packet_received_us() >= sim.last_report_us();
+        if (reported && it->confirmed()) {
+          latency_ms.add((now - it->issued_us) / 1000.0);
+          it = pending.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    };
+
+    ac->setup();
+
+    uint64_t boot_us = host::now_us();
+    uint64_t session_end_us = boot_us + static_cast<uint64_t>(options.session_s * 1e6);
+    uint64_t next_command_us = 0;
+    bool ready = false;
+
+    while (host::now_us() < session_end_us) {
+      sim.tick();
+
+      if (ac->is_failed()) {
+        failed_sessions++;
+        break;
+      }
+
+      uint64_t acked_before = sim.stats().reports_acked;
+
+      auto start = std::chrono::steady_clock::now();
+      ac->loop();
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+      loop_ns.add(ns);
+      loops++;
+
+      confirm_pending();
+
+      uint64_t now = host::now_us();
+
+      if (!ready && ac->is_ready()) {
+        ready = true;
+        bool resumed = sim.stats().handshakes == handshakes_before;
+        (resumed ? resume_ready_ms : handshake_ready_ms).add((now - boot_us) / 1000.0);
+        next_command_us = now + static_cast<uint64_t>(next_command(random) * 1e6);
+      }
+
+      if (ready && sim.stats().reports_acked != acked_before)
+        report_loop_ns.add(ns);
+
+      if (ready && now >= next_command_us) {
+        if (std::uniform_int_distribution<int>(0, 1)(random) == 0) {
+          float target = std::uniform_int_distribution<int>(34, 56)(random) * 0.5f;
+          SoakWLAN *device = ac.get();
+          ac->make_call().set_target_temperature(target).perform();
+          pending.push_back({now, [device, target]() { return device->target_temperature == target; }});
+        } else {
+          bool state = !nanoex.state;
+          if (state)
+            nanoex.turn_on();
+          else
+            nanoex.turn_off();
+          pending.push_back({now, [&sim, state]() { return (sim.value(0x33) != 0x42) == state; }});
+        }
+        next_command_us = now + static_cast<uint64_t>(next_command(random) * 1e6);
+      }
+
+      for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->issued_us > expectation_timeout_us) {
+          unconfirmed++;
+          it = pending.erase(it);
+        } else {
+          ++it;
+        }
+      }
+
+      host::advance_time_us(loop_us);
+    }
+
+    if (!ready && !ac->is_failed())
+      failed_sessions++;
+
+    ac->on_safe_shutdown();  // The module reboots like it does for an OTA update
+
+    if (options.trace) {
+      host::set_log_level(std::max(options.log_level, ESPHOME_LOG_LEVEL_INFO));
+      ac->dump_trace();
+      host::set_log_level(options.log_level);
+    }
+
+    frames_resent += ac->get_frames_resent();
+    publishes += ac->get_publishes();
+    publishes_suppressed += ac->get_publishes_suppressed();
+    frames_unchanged += ac->get_frames_unchanged();
+    intents_confirmed += ac->get_intents_confirmed();
+    intents_timed_out += ac->get_intents_timed_out();
+    resend_give_ups += ac->get_resend_give_ups();
+    session_writes += ac->get_session_writes();
+    transmit_latency.merge(ac->get_transmit_latency());
+    ack_latency.merge(ac->get_ack_latency());
+    confirm_latency.merge(ac->get_confirm_latency());
+    commands_unconfirmed += ac->get_commands_unconfirmed();
+    raw_publishes += raw_sensor_21.publish_count + raw_sensor_86.publish_count;
+    raw_21 = raw_sensor_21.state;
+    raw_86 = raw_sensor_86.state;
+    for (size_t i = 0; i < panasonic_ac::LINK_COUNTER_COUNT; i++)
+      link[i] += ac->get_link_stats().total(static_cast<panasonic_ac::LinkCounter>(i));
+  }
+
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  double hours = (host::now_us() - start_us) / 3.6e9;
+  const auto &stats = sim.stats();
+
+  std::printf("CN-WLAN soak: %u boots, %.2f simulated hours in %.2f s wall time\n", options.reboots + 1, hours,
+              wall_s);
+  std::printf("Startup:\n");
+  handshake_ready_ms.print("boot -> Ready (handshake)", "ms");
+  resume_ready_ms.print("boot -> Ready (resumed)", "ms");
+  std::printf("  %-32s %llu\n", "failed sessions", (unsigned long long) failed_sessions);
+  std::printf("  %-32s %llu\n", "completed handshakes", (unsigned long long) stats.handshakes);
+  std::printf("  %-32s %llu (%.1f/day)\n", "session writes", (unsigned long long) session_writes,
+              session_writes / hours * 24);
+  std::printf("Commands:\n");
+  latency_ms.print("command -> report", "ms");
+  std::printf("  %-32s %llu\n", "unconfirmed after 60 s", (unsigned long long) unconfirmed);
+  std::printf("  %-32s %llu confirmed, %llu timed out\n", "requested fields", (unsigned long long) intents_confirmed,
+              (unsigned long long) intents_timed_out);
+  std::printf("  As timed by the component:\n");
+  host::print_latency("requested -> written", transmit_latency);
+  host::print_latency("written -> acked", ack_latency);
+  host::print_latency("requested -> confirmed", confirm_latency);
+  std::printf("  %-32s %llu\n", "never confirmed", (unsigned long long) commands_unconfirmed);
+  std::printf("Bus:\n");
+  std::printf("  %-32s %llu (%.2f%% resends)\n", "requests", (unsigned long long) stats.requests,
+              stats.requests == 0 ? 0.0 : 100.0 * stats.resends / stats.requests);
+  std::printf("  %-32s %llu polls, %llu sets\n", "", (unsigned long long) stats.polls, (unsigned long long) stats.sets);
+  std::printf("  %-32s %llu sent, %llu answered\n", "pings", (unsigned long long) stats.pings,
+              (unsigned long long) stats.pings_answered);
+  std::printf("  %-32s %llu sent, %llu acked\n", "reports", (unsigned long long) stats.reports,
+              (unsigned long long) stats.reports_acked);
+  std::printf("  %-32s %llu resent, %llu given up\n", "frames by component", (unsigned long long) frames_resent,
+              (unsigned long long) resend_give_ups);
+  std::printf("  %-32s %llu\n", "counter mismatches", (unsigned long long) stats.counter_mismatches);
+  std::printf("  %-32s %llu\n", "requests outside a session", (unsigned long long) stats.sessionless);
+  std::printf("  %-32s %.0f B/h to unit, %.0f B/h from unit\n", "traffic", stats.bytes_received / hours,
+              stats.bytes_sent / hours);
+  std::printf("Link, as counted by the component:\n");
+  host::print_link(link);
+  std::printf("CPU:\n");
+  loop_ns.print("loop()", "ns");
+  report_loop_ns.print("loop() handling a report", "ns");
+  std::printf("  %-32s %llu of %llu polls\n", "unchanged queries skipped",
+              (unsigned long long) frames_unchanged, (unsigned long long) stats.polls);
+  std::printf("  %-32s %llu, %llu suppressed\n", "entity publishes", (unsigned long long) publishes,
+              (unsigned long long) publishes_suppressed);
+  std::printf("  %-32s %llu, last 0x21 = %.1f, 0x86 = %.1f\n", "raw sensor publishes",
+              (unsigned long long) raw_publishes, raw_21, raw_86);
+
+  return 0;
+}
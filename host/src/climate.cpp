@@ -0,0 +1,101 @@
+#include "esphome/components/climate/climate.h"
+
+namespace esphome {
+namespace climate {
+
+void ClimateCall::perform() { this->parent_->control(*this); }
+
+void Climate::publish_state() {
+  this->publish_count++;
+  for (auto &callback : this->state_callbacks_)
+    callback(*this);
+}
+
+const char *climate_mode_to_string(ClimateMode mode) {
+  switch (mode) {
+    case CLIMATE_MODE_OFF:
+      return "OFF";
+    case CLIMATE_MODE_HEAT_COOL:
+      return "HEAT_COOL";
+    case CLIMATE_MODE_COOL:
+      return "COOL";
+    case CLIMATE_MODE_HEAT:
+      return "HEAT";
+    case CLIMATE_MODE_FAN_ONLY:
+      return "FAN_ONLY";
+    case CLIMATE_MODE_DRY:
+      return "DRY";
+    case CLIMATE_MODE_AUTO:
+      return "AUTO";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+const char *climate_fan_mode_to_string(ClimateFanMode mode) {
+  switch (mode) {
+    case CLIMATE_FAN_ON:
+      return "ON";
+    case CLIMATE_FAN_OFF:
+      return "OFF";
+    case CLIMATE_FAN_AUTO:
+      return "AUTO";
+    case CLIMATE_FAN_LOW:
+      return "LOW";
+    case CLIMATE_FAN_MEDIUM:
+      return "MEDIUM";
+    case CLIMATE_FAN_HIGH:
+      return "HIGH";
+    case CLIMATE_FAN_MIDDLE:
+      return "MIDDLE";
+    case CLIMATE_FAN_FOCUS:
+      return "FOCUS";
+    case CLIMATE_FAN_DIFFUSE:
+      return "DIFFUSE";
+    case CLIMATE_FAN_QUIET:
+      return "QUIET";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+const char *climate_swing_mode_to_string(ClimateSwingMode mode) {
+  switch (mode) {
+    case CLIMATE_SWING_OFF:
+      return "OFF";
+    case CLIMATE_SWING_BOTH:
+      return "BOTH";
+    case CLIMATE_SWING_VERTICAL:
+      return "VERTICAL";
+    case CLIMATE_SWING_HORIZONTAL:
+      return "HORIZONTAL";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+const char *climate_preset_to_string(ClimatePreset preset) {
+  switch (preset) {
+    case CLIMATE_PRESET_NONE:
+      return "NONE";
+    case CLIMATE_PRESET_HOME:
+      return "HOME";
+    case CLIMATE_PRESET_AWAY:
+      return "AWAY";
+    case CLIMATE_PRESET_BOOST:
+      return "BOOST";
+    case CLIMATE_PRESET_COMFORT:
+      return "COMFORT";
+    case CLIMATE_PRESET_ECO:
+      return "ECO";
+    case CLIMATE_PRESET_SLEEP:
+      return "SLEEP";
+    case CLIMATE_PRESET_ACTIVITY:
+      return "ACTIVITY";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+}  // namespace climate
+}  // namespace esphome
@@ -0,0 +1,49 @@
+#include "esphome/core/hal.h"
+
+#include <chrono>
+#include <thread>
+
+namespace esphome {
+
+namespace {
+
+bool virtual_clock = false;
+uint64_t virtual_now_us = 0;
+const auto start_time = std::chrono::steady_clock::now();
+
+}  // namespace
+
+namespace host {
+
+void set_virtual_clock(bool enabled) { virtual_clock = enabled; }
+
+bool is_virtual_clock() { return virtual_clock; }
+
+void advance_time_us(uint64_t us) {
+  if (virtual_clock)
+    virtual_now_us += us;
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+uint64_t now_us() {
+  if (virtual_clock)
+    return virtual_now_us;
+
+  auto elapsed = std::chrono::steady_clock::now() - start_time;
+  return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+}  // namespace host
+
+uint32_t millis() { return static_cast<uint32_t>(host::now_us() / 1000); }
+
+uint32_t micros() { return static_cast<uint32_t>(host::now_us()); }
+
+void delay(uint32_t ms) { host::advance_time_us(uint64_t(ms) * 1000); }
+
+void delayMicroseconds(uint32_t us) { host::advance_time_us(us); }
+
+void yield() {}
+
+}  // namespace esphome
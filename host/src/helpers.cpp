@@ -0,0 +1,34 @@
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+std::string format_hex_pretty(const uint8_t *data, size_t length) {
+  static const char HEX_CHARS[] = "0123456789ABCDEF";
+
+  if (data == nullptr || length == 0)
+    return "";
+
+  std::string ret;
+  ret.resize(3 * length - 1);
+  for (size_t i = 0; i < length; i++) {
+    ret[3 * i] = HEX_CHARS[(data[i] & 0xF0) >> 4];
+    ret[3 * i + 1] = HEX_CHARS[data[i] & 0x0F];
+    if (i != length - 1)
+      ret[3 * i + 2] = '.';
+  }
+
+  return ret + " (" + std::to_string(length) + ")";
+}
+
+std::string format_hex_pretty(const std::vector<uint8_t> &data) { return format_hex_pretty(data.data(), data.size()); }
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= c;
+  }
+  return hash;
+}
+
+}  // namespace esphome
@@ -0,0 +1,37 @@
+#include "host/host_uart.h"
+
+namespace esphome {
+namespace host {
+
+void HostUART::feed(const uint8_t *data, size_t len) { this->rx_.insert(this->rx_.end(), data, data + len); }
+
+void HostUART::write_array(const uint8_t *data, size_t len) {
+  this->bytes_written_ += len;
+
+  if (this->write_callback_)
+    this->write_callback_(data, len);
+}
+
+bool HostUART::peek_byte(uint8_t *data) {
+  if (this->rx_.empty())
+    return false;
+
+  *data = this->rx_.front();
+  return true;
+}
+
+bool HostUART::read_array(uint8_t *data, size_t len) {
+  if (this->rx_.size() < len)
+    return false;
+
+  for (size_t i = 0; i < len; i++) {
+    data[i] = this->rx_.front();
+    this->rx_.pop_front();
+  }
+
+  this->bytes_read_ += len;
+  return true;
+}
+
+}  // namespace host
+}  // namespace esphome
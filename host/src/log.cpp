@@ -0,0 +1,38 @@
+#include "esphome/core/log.h"
+
+#include <cstdio>
+
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+namespace {
+
+int current_log_level = ESPHOME_LOG_LEVEL_DEBUG;
+
+const char LEVEL_LETTERS[] = "-EWICDVV";
+
+}  // namespace
+
+namespace host {
+
+int log_level() { return current_log_level; }
+
+void set_log_level(int level) { current_log_level = level; }
+
+}  // namespace host
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {
+  uint64_t now = host::now_us();
+  std::fprintf(stderr, "[%llu.%03llu][%c][%s:%03d]: ", (unsigned long long) (now / 1000000),
+               (unsigned long long) ((now / 1000) % 1000), LEVEL_LETTERS[level & 7], tag, line);
+
+  va_list args;
+  va_start(args, format);
+  std::vfprintf(stderr, format, args);
+  va_end(args);
+
+  std::fputc('\n', stderr);
+}
+
+}  // namespace esphome
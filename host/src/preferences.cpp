@@ -0,0 +1,84 @@
+#include "esphome/core/preferences.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace esphome {
+
+namespace {
+
+std::map<uint32_t, std::vector<uint8_t>> stored;
+uint32_t writes = 0;
+
+class HostPreferenceBackend : public ESPPreferenceBackend {
+ public:
+  HostPreferenceBackend(uint32_t type, size_t length) : type_(type), length_(length) {}
+
+  bool save(const uint8_t *data, size_t len) override {
+    if (len != this->length_)
+      return false;
+
+    std::vector<uint8_t> value(data, data + len);
+    auto &slot = stored[this->type_];
+    if (slot != value) {
+      slot = value;
+      writes++;
+    }
+    return true;
+  }
+
+  bool load(uint8_t *data, size_t len) override {
+    auto it = stored.find(this->type_);
+    if (len != this->length_ || it == stored.end() || it->second.size() != len)
+      return false;
+
+    std::copy(it->second.begin(), it->second.end(), data);
+    return true;
+  }
+
+ protected:
+  uint32_t type_;
+  size_t length_;
+};
+
+class HostPreferences : public ESPPreferences {
+ public:
+  ESPPreferenceObject make_preference(size_t length, uint32_t type, bool /*in_flash*/) override {
+    return this->make_preference(length, type);
+  }
+
+  ESPPreferenceObject make_preference(size_t length, uint32_t type) override {
+    this->backends_.push_back(std::make_unique<HostPreferenceBackend>(type, length));
+    return ESPPreferenceObject(this->backends_.back().get());
+  }
+
+  bool sync() override { return true; }
+
+  bool reset() override {
+    host::clear_preferences();
+    return true;
+  }
+
+ protected:
+  std::vector<std::unique_ptr<HostPreferenceBackend>> backends_;
+};
+
+HostPreferences host_preferences;
+
+}  // namespace
+
+ESPPreferences *global_preferences = &host_preferences;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+namespace host {
+
+void clear_preferences() {
+  stored.clear();
+  writes = 0;
+}
+
+uint32_t preference_writes() { return writes; }
+
+}  // namespace host
+}  // namespace esphome
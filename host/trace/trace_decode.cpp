@@ -0,0 +1,230 @@
+/*
+ * Decodes packet traces dumped by PanasonicAC::dump_trace() from a log
+ *
+ * Usage: trace_decode [log file]...
+ *
+ * Reads the logs (stdin if no file is given), picks out the "trace" lines of every dump and prints the frames they
+ * hold, oldest first, with their time relative to the dump, the gap to the previous frame and what kind of frame it is.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "esppac_trace.h"
+
+namespace {
+
+using esphome::panasonic_ac::TRACE_HEADER_SIZE;
+using esphome::panasonic_ac::TRACE_OUTGOING;
+
+struct Dump {
+  uint32_t records = 0;
+  uint32_t bytes = 0;
+  uint32_t now = 0;
+  bool frozen = false;
+  std::vector<uint8_t> data;
+};
+
+// Removes the terminal colour codes the ESPHome logger adds
+std::string strip_colours(const std::string &line) {
+  std::string out;
+
+  for (size_t i = 0; i < line.size(); i++) {
+    if (line[i] == '\033') {
+      while (i < line.size() && line[i] != 'm')
+        i++;
+      continue;
+    }
+    out += line[i];
+  }
+
+  return out;
+}
+
+// The message of a log line if it belongs to a trace dump, empty otherwise
+std::string trace_message(const std::string &line) {
+  size_t start = line.find("]: trace ");
+
+  if (start != std::string::npos)
+    start += 3;
+  else if (line.rfind("trace ", 0) == 0)
+    start = 0;
+  else
+    return "";
+
+  std::string message = line.substr(start + 6);
+  while (!message.empty() && (message.back() == '\r' || message.back() == ' '))
+    message.pop_back();
+  return message;
+}
+
+uint32_t field(const std::string &message, const char *name) {
+  size_t pos = message.find(std::string(name) + "=");
+  return pos == std::string::npos ? 0 : std::strtoul(message.c_str() + pos + std::strlen(name) + 1, nullptr, 10);
+}
+
+bool parse_hex(const std::string &hex, std::vector<uint8_t> *out) {
+  if (hex.size() % 2 != 0)
+    return false;
+
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    char byte[3] = {hex[i], hex[i + 1], '\0'};
+    char *end;
+    out->push_back(std::strtoul(byte, &end, 16));
+    if (*end != '\0')
+      return false;
+  }
+
+  return true;
+}
+
+const char *describe(const uint8_t *frame, size_t length, bool outgoing) {
+  if (length == 0)
+    return "";
+
+  switch (frame[0]) {
+    case 0x70:
+      return outgoing ? "CN-CNT poll" : "CN-CNT poll response";
+    case 0xF0:
+      return outgoing ? "CN-CNT control" : "CN-CNT control answer";
+    case 0x66:
+      return "CN-WLAN sync";
+    case 0x5A:
+      break;
+    default:
+      return "unknown header";
+  }
+
+  if (length < 4)
+    return "CN-WLAN, too short";
+
+  switch ((frame[2] << 8) | frame[3]) {
+    case 0x0101:
+      return "CN-WLAN ping";
+    case 0x0181:
+      return "CN-WLAN ping answer";
+    case 0x1009:
+      return "CN-WLAN query";
+    case 0x1089:
+      return "CN-WLAN query response";
+    case 0x1008:
+      return "CN-WLAN set command";
+    case 0x1088:
+      return "CN-WLAN command ack";
+    case 0x100A:
+      return "CN-WLAN report";
+    case 0x108A:
+      return "CN-WLAN report ack";
+    default:
+      return "CN-WLAN handshake";
+  }
+}
+
+void print_dump(const Dump &dump, size_t index) {
+  std::printf("Trace %zu: %u frames, %u bytes%s\n", index, dump.records, dump.bytes,
+              dump.frozen ? ", frozen on an error" : "");
+
+  if (dump.data.size() != dump.bytes)
+    std::printf("  %zu of %u bytes found in the log, the dump is incomplete\n", dump.data.size(), dump.bytes);
+
+  std::printf("  %11s %9s %-3s %4s  %-24s %s\n", "time (ms)", "gap (ms)", "dir", "len", "frame", "bytes");
+
+  const size_t header_size = TRACE_HEADER_SIZE;
+  size_t offset = 0, frames = 0;
+  uint32_t previous = 0;
+
+  while (offset + header_size <= dump.data.size()) {
+    const uint8_t *header = dump.data.data() + offset;
+    uint32_t time = header[0] | (header[1] << 8) | (header[2] << 16) | (uint32_t(header[3]) << 24);
+    bool outgoing = header[4] & TRACE_OUTGOING;
+    size_t length = header[5] | (header[6] << 8);
+
+    if (offset + header_size + length > dump.data.size()) {
+      std::printf("  frame at byte %zu is cut off\n", offset);
+      break;
+    }
+
+    const uint8_t *frame = header + header_size;
+    uint8_t checksum = 0;
+    for (size_t i = 0; i < length; i++)
+      checksum += frame[i];
+
+    // Times are micros() of the device, differences stay right across the 32 bit wrap
+    double age = -double(uint32_t(dump.now - time)) / 1000.0;
+    double gap = frames == 0 ? 0.0 : double(uint32_t(time - previous)) / 1000.0;
+
+    std::printf("  %11.3f %9.3f %-3s %4zu  %-24s", age, gap, outgoing ? "TX" : "RX", length,
+                describe(frame, length, outgoing));
+    for (size_t i = 0; i < length; i++)
+      std::printf(" %02X", frame[i]);
+    std::printf("%s\n", checksum != 0 ? "  [bad checksum]" : "");
+
+    previous = time;
+    offset += header_size + length;
+    frames++;
+  }
+
+  if (frames != dump.records)
+    std::printf("  decoded %zu frames, the dump announced %u\n", frames, dump.records);
+}
+
+void decode(std::istream &in, size_t *dumps) {
+  std::string line;
+  Dump dump;
+  bool in_dump = false;
+
+  while (std::getline(in, line)) {
+    std::string message = trace_message(strip_colours(line));
+    if (message.empty())
+      continue;
+
+    if (message.rfind("begin", 0) == 0) {
+      dump = Dump();
+      dump.records = field(message, "records");
+      dump.bytes = field(message, "bytes");
+      dump.now = field(message, "now");
+      dump.frozen = field(message, "frozen") != 0;
+      in_dump = true;
+    } else if (message == "end" && in_dump) {
+      print_dump(dump, (*dumps)++);
+      in_dump = false;
+    } else if (in_dump && !parse_hex(message, &dump.data)) {
+      std::fprintf(stderr, "Skipping malformed trace line: %s\n", line.c_str());
+    }
+  }
+
+  if (in_dump)
+    print_dump(dump, (*dumps)++);  // Log ended before the dump did, show what there is
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t dumps = 0;
+
+  if (argc < 2) {
+    decode(std::cin, &dumps);
+  } else {
+    for (int i = 1; i < argc; i++) {
+      std::ifstream file(argv[i]);
+      if (!file) {
+        std::fprintf(stderr, "Cannot open %s\n", argv[i]);
+        return 1;
+      }
+      decode(file, &dumps);
+    }
+  }
+
+  if (dumps == 0) {
+    std::fprintf(stderr, "No trace dump found\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,407 @@
+#!/usr/bin/env python3
+"""Generate the frame codecs in components/panasonic_ac/esppac_schema.h from protocol/schema.json.
+
+Every frame becomes a reader class with a getter per field, writable frames also get a writer class with setters.
+Offsets and masks end up as template arguments, so the generated code is as cheap as indexing the buffer by hand while
+FrameReader/FrameWriter (esppac_fields.h) reject fields outside of the frame at compile time.
+
+Usage: generate.py [--schema SCHEMA] [--output OUTPUT] [--check]
+"""
+
+import argparse
+import json
+import os
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_SCHEMA = os.path.join(ROOT, "protocol", "schema.json")
+DEFAULT_OUTPUT = os.path.join(ROOT, "components", "panasonic_ac", "esppac_schema.h")
+LINE_LENGTH = 120  # As in .clang-format
+
+TYPES = {
+    # type: (C++ type, size in bytes, accessor suffix)
+    "u8": ("uint8_t", 1, "u8"),
+    "i8": ("int8_t", 1, "i8"),
+    "flag": ("bool", 1, "flag"),
+    "u16le": ("uint16_t", 2, "u16le"),
+    "u16be": ("uint16_t", 2, "u16be"),
+}
+
+
+class SchemaError(Exception):
+    pass
+
+
+def camel(name):
+    return "".join(part.capitalize() for part in name.split("_"))
+
+
+def number(value):
+    return int(value, 0) if isinstance(value, str) else int(value)
+
+
+def comment(description):
+    return f"  // {description}" if description else ""
+
+
+def commented(out, line, description, indent="  "):
+    """Appends line with a trailing comment, or with the comment above it if that gets too long."""
+    if description and len(line + comment(description)) > LINE_LENGTH:
+        out.append(f"{indent}// {description}")
+        out.append(line)
+    else:
+        out.append(line + comment(description))
+
+
+def check_fields(protocol, frame_name, frame):
+    size = frame["size"]
+    used = {}
+
+    for name, field in frame.get("fields", {}).items():
+        field_type = field.get("type", "u8")
+        if field_type not in TYPES:
+            raise SchemaError(f"{protocol}.{frame_name}.{name}: unknown type {field_type}")
+
+        offset = number(field["offset"])
+        width = TYPES[field_type][1]
+        if offset + width > size:
+            raise SchemaError(f"{protocol}.{frame_name}.{name}: offset {offset} lies outside of the frame")
+
+        mask = number(field.get("mask", "0xFF"))
+        if field_type == "flag" and "mask" not in field:
+            raise SchemaError(f"{protocol}.{frame_name}.{name}: flags need a mask")
+        if width == 2 and "mask" in field:
+            raise SchemaError(f"{protocol}.{frame_name}.{name}: masks are only supported on single bytes")
+
+        for byte in range(offset, offset + width):
+            if used.get(byte, 0) & mask:
+                raise SchemaError(f"{protocol}.{frame_name}.{name}: overlaps another field")
+            used[byte] = used.get(byte, 0) | mask
+
+
+def emit_tables(out, protocol):
+    tables = protocol.get("tables", {})
+    if not tables:
+        return
+
+    out.append("/*")
+    out.append(" * Field tables, the enums list the values in table order")
+    out.append(" */")
+    out.append("")
+
+    for name, table in tables.items():
+        enum = table["enum"]
+        values = table["values"]
+        names = [value[0] for value in values] + ["Unknown"]
+
+        out.append(f"enum class {enum} : uint8_t {{ {', '.join(names)} }};")
+        out.append("")
+
+        if table.get("description"):
+            out.append(f"// {table['description']}")
+        out.append(f"static constexpr FieldTable<{enum}, {len(values)}> {name.upper()} = {{{{")
+        for _, wire, label in values:
+            out.append(f'    {{0x{number(wire):02X}, "{label}"}},')
+        out.append("}};")
+        out.append("")
+
+
+def emit_keys(out, protocol):
+    keys = protocol.get("keys", {})
+    if not keys:
+        return
+
+    out.append("/*")
+    out.append(" * Keys of key value pairs")
+    out.append(" */")
+    out.append("")
+
+    width = max(len(f"static const uint8_t KEY_{name.upper()} = 0x00;") for name in keys)
+    for name, key in keys.items():
+        description = key.get("description", "")
+        if "table" in key:
+            description = f"See {key['table'].upper()}"
+        line = f"static const uint8_t KEY_{name.upper()} = 0x{number(key['key']):02X};"
+        out.append(line.ljust(width) + comment(description))
+    out.append("")
+
+
+def emit_getters(out, frame):
+    for name, field in frame.get("fields", {}).items():
+        field_type = field.get("type", "u8")
+        cpp_type, _, suffix = TYPES[field_type]
+        offset = number(field["offset"])
+        args = str(offset)
+        if "mask" in field:
+            args += f", 0x{number(field['mask']):02X}"
+
+        description = field.get("description", "")
+        if "table" in field:
+            description = f"See {field['table'].upper()}"
+
+        commented(out, f"  constexpr {cpp_type} {name}() const {{ return this->get_{suffix}<{args}>(); }}", description)
+
+
+def emit_setters(out, frame):
+    for name, field in frame.get("fields", {}).items():
+        field_type = field.get("type", "u8")
+        cpp_type, _, suffix = TYPES[field_type]
+        offset = number(field["offset"])
+        args = str(offset)
+        if "mask" in field:
+            args += f", 0x{number(field['mask']):02X}"
+
+        out.append(f"  void set_{name}({cpp_type} value) {{ this->set_{suffix}<{args}>(value); }}")
+
+
+def emit_field_masks(out, frame):
+    fields = frame.get("fields", {})
+    names = [f"FIELD_{name.upper()}" for name in fields] + ["FIELD_COUNT"]
+
+    out.append("  // Fields in schema order, for code that handles them generically")
+    enum = f"  enum Field : uint8_t {{ {', '.join(names)} }};"
+    if len(enum) <= LINE_LENGTH:
+        out.append(enum)
+    else:
+        out.append("  enum Field : uint8_t {")
+        for name in names:
+            out.append(f"    {name},")
+        out.append("  };")
+
+    out.append("  static constexpr FieldMask FIELDS[FIELD_COUNT] = {")
+    for name, field in fields.items():
+        out.append(f"      {{{number(field['offset'])}, 0x{number(field.get('mask', '0xFF')):02X}}},  // {name}")
+    out.append("  };")
+
+
+def emit_blocks(out, frame, frames, writer):
+    for name, block in frame.get("blocks", {}).items():
+        offset = number(block["offset"])
+        inner = camel(block["frame"]) + ("Writer" if writer else "")
+        inner_size = frames[block["frame"]]["size"]
+        data = "this->mutable_data_" if writer else "this->data_"
+
+        out.append(f"  {inner} {name}() const {{")
+        out.append(f'    static_assert({offset} + {inner_size} <= SIZE, "Block lies outside of its frame");')
+        out.append(f"    return {inner}({data} + {offset}, {inner_size});")
+        out.append("  }")
+
+
+def emit_records(out, frame, frames, writer):
+    for name, record in frame.get("records", {}).items():
+        offset = number(record["offset"])
+        inner = camel(record["frame"]) + ("Writer" if writer else "")
+        stride = frames[record["frame"]]["size"]
+        data = "this->mutable_data_" if writer else "this->data_"
+
+        out.append("")
+        out.append(f"  // Number of {name}, clamped to the ones that fit into the buffer")
+        out.append(f"  size_t {name}_size() const {{")
+        out.append(f'    static_assert({offset} <= SIZE, "Records lie outside of their frame");')
+        out.append(f"    size_t fits = (this->length_ - {offset}) / {stride};")
+        out.append(f"    return std::min<size_t>(this->{record['count']}(), fits);")
+        out.append("  }")
+        out.append("")
+        if writer:
+            out.append(f"  // Record at index, returns false if index is past {name}_size()")
+            out.append(f"  bool {name}_at(size_t index, {inner} *record) const {{")
+            out.append(f"    if (index >= this->{name}_size())")
+            out.append("      return false;")
+            out.append("")
+            out.append(f"    *record = {inner}({data} + {offset} + index * {stride}, {stride});")
+            out.append("    return true;")
+            out.append("  }")
+        else:
+            out.append(f"  // Record at index, or a default constructed one if index is past {name}_size()")
+            out.append(f"  {inner} {name}_at(size_t index) const {{")
+            out.append(f"    if (index >= this->{name}_size())")
+            out.append(f"      return {inner}();")
+            out.append("")
+            out.append(f"    return {inner}({data} + {offset} + index * {stride}, {stride});")
+            out.append("  }")
+
+
+def embedders(frames, frame_name, writer):
+    """Frames that construct views of frame_name through a block or record."""
+    result = []
+    for name, frame in frames.items():
+        if writer and not frame.get("writable"):
+            continue
+        nested = list(frame.get("blocks", {}).values()) + list(frame.get("records", {}).values())
+        if any(item["frame"] == frame_name for item in nested):
+            result.append(name)
+    return result
+
+
+def emit_frame(out, frame_name, frame, frames, writer):
+    base = "FrameWriter" if writer else "FrameReader"
+    class_name = camel(frame_name) + ("Writer" if writer else "")
+    pointer = "uint8_t *" if writer else "const uint8_t *"
+    size = frame["size"]
+
+    if frame.get("description"):
+        out.append(f"// {frame['description']}")
+    out.append(f"class {class_name} : public {base}<{size}> {{")
+    out.append(" public:")
+    out.append(f"  constexpr {class_name}() = default;")
+    out.append("")
+    out.append("  // Returns false if the buffer is too short to hold the frame")
+    out.append(f"  static bool wrap({pointer}data, size_t length, {class_name} *frame) {{")
+    out.append("    if (length < SIZE)")
+    out.append("      return false;")
+    out.append("")
+    out.append(f"    *frame = {class_name}(data, length);")
+    out.append("    return true;")
+    out.append("  }")
+    out.append("")
+    if writer:
+        out.append(f"  static {class_name} edit(FrameData<SIZE> &frame) {{ return {class_name}(frame.bytes, SIZE); }}")
+    else:
+        out.append(f"  static {class_name} view(const FrameData<SIZE> &frame) {{ return {class_name}(frame.bytes, SIZE); }}")
+    out.append("")
+
+    if frame.get("field_masks") and not writer:
+        emit_field_masks(out, frame)
+        out.append("")
+
+    emit_getters(out, frame)
+    if writer:
+        out.append("")
+        emit_setters(out, frame)
+
+    if frame.get("blocks"):
+        out.append("")
+        emit_blocks(out, frame, frames, writer)
+    emit_records(out, frame, frames, writer)
+
+    out.append("")
+    out.append(" protected:")
+    for friend in embedders(frames, frame_name, writer):
+        out.append(f"  friend class {camel(friend)}{'Writer' if writer else ''};")
+    out.append(f"  constexpr {class_name}({pointer}data, size_t length) : {base}(data, length) {{}}")
+    out.append("};")
+    out.append("")
+    if not writer:
+        out.append(f"using {class_name}Data = FrameData<{class_name}::SIZE>;")
+        out.append("")
+
+
+def order_frames(frames):
+    """Frames sorted so that embedded frames are declared before the frames embedding them."""
+    ordered = []
+
+    def visit(name, stack):
+        if name in ordered:
+            return
+        if name in stack:
+            raise SchemaError(f"frame {name} embeds itself")
+        frame = frames[name]
+        nested = list(frame.get("blocks", {}).values()) + list(frame.get("records", {}).values())
+        for item in nested:
+            if item["frame"] not in frames:
+                raise SchemaError(f"frame {name} embeds unknown frame {item['frame']}")
+            visit(item["frame"], stack + [name])
+        ordered.append(name)
+
+    for name in frames:
+        visit(name, [])
+    return ordered
+
+
+def emit_protocol(out, name, protocol):
+    frames = protocol.get("frames", {})
+    for frame_name, frame in frames.items():
+        check_fields(name, frame_name, frame)
+        if frame.get("field_masks") and any(TYPES[f.get("type", "u8")][1] != 1 for f in frame["fields"].values()):
+            raise SchemaError(f"{name}.{frame_name}: field masks need single byte fields")
+        for field_name, field in frame.get("fields", {}).items():
+            if "table" in field and field["table"] not in protocol.get("tables", {}):
+                raise SchemaError(f"{name}.{frame_name}.{field_name}: unknown table {field['table']}")
+        for record_name, record in frame.get("records", {}).items():
+            if record["count"] not in frame.get("fields", {}):
+                raise SchemaError(f"{name}.{frame_name}.{record_name}: unknown count field {record['count']}")
+
+    out.append(f"namespace {protocol['namespace']} {{")
+    out.append("")
+    if protocol.get("description"):
+        out.append(f"// {protocol['description']}")
+        out.append("")
+
+    emit_tables(out, protocol)
+    emit_keys(out, protocol)
+
+    if frames:
+        out.append("/*")
+        out.append(" * Frames")
+        out.append(" */")
+        out.append("")
+
+    for frame_name in order_frames(frames):
+        emit_frame(out, frame_name, frames[frame_name], frames, False)
+        if frames[frame_name].get("writable"):
+            emit_frame(out, frame_name, frames[frame_name], frames, True)
+
+    out.append(f"}}  // namespace {protocol['namespace']}")
+    out.append("")
+
+
+def generate(schema):
+    out = [
+        "// Generated by protocol/generate.py from protocol/schema.json, do not edit",
+        "",
+        "#pragma once",
+        "",
+        "#include <algorithm>",
+        "#include <cstddef>",
+        "#include <cstdint>",
+        "",
+        '#include "esppac_fields.h"',
+        "",
+        "namespace esphome {",
+        "namespace panasonic_ac {",
+        "",
+    ]
+
+    for name, protocol in schema["protocols"].items():
+        emit_protocol(out, name, protocol)
+
+    out.append("}  // namespace panasonic_ac")
+    out.append("}  // namespace esphome")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--schema", default=DEFAULT_SCHEMA)
+    parser.add_argument("--output", default=DEFAULT_OUTPUT)
+    parser.add_argument("--check", action="store_true", help="only check that the output is up to date")
+    args = parser.parse_args()
+
+    with open(args.schema) as f:
+        schema = json.load(f)
+
+    try:
+        header = generate(schema)
+    except (SchemaError, KeyError) as e:
+        print(f"{args.schema}: {e}", file=sys.stderr)
+        return 1
+
+    current = None
+    if os.path.exists(args.output):
+        with open(args.output) as f:
+            current = f.read()
+
+    if args.check:
+        if current != header:
+            print(f"{args.output} is out of date, run {os.path.relpath(__file__, ROOT)}", file=sys.stderr)
+            return 1
+        return 0
+
+    if current != header:  # Keep the timestamp so the build doesn't recompile for nothing
+        with open(args.output, "w") as f:
+            f.write(header)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())